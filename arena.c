@@ -0,0 +1,157 @@
+/******************************************************************************
+
+File Name:      arena.c
+Description:    This program implements a last in, first out arena of bytes
+                over the array-based stack in stack.c.  Allocations are
+                carved from the elements of the stack by moving its stack
+                pointer, and given back by rolling the stack back to a mark,
+                so an arena costs one allocation however many temporaries
+                it hands out.
+
+******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include "arena.h"
+#include "mylib.h"
+#include "stats.h"
+#include "trace.h"
+
+/* catastrophic error messages */
+static const char ALIGN_INVALID[] = "Aligning to a non-power of two!!!\n";
+static const char ARENA_FULL[] = "Allocating past the end of an arena!!!\n";
+static const char ARENA_NONEXIST[] =
+                        "Allocating from a non-existent arena!!!\n";
+
+
+/* deallocates the arena as delete_Stack does */
+void delete_Arena (Arena ** app)
+{
+    delete_Stack (app);
+}
+
+
+/* marks the arena as mark_Stack does */
+long mark_Arena (Arena * this_Arena)
+{
+    return mark_Stack (this_Arena);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          new_Arena
+Purpose:                This function allocates an arena
+Description:            This function allocates a stack of enough longs to
+                        hold the number of bytes
+Input:                  bytes: number of bytes the arena can hand out
+Result:                 The result of new_Stack, which prints the error
+                        messages
+----------------------------------------------------------------------------*/
+Arena * new_Arena (unsigned long bytes)
+{
+    return new_Stack (bytes / sizeof(long) + (bytes % sizeof(long) != 0));
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          pop_to_mark
+Purpose:                This function gives back memory down to a mark
+Description:            This function rolls the stack back to the mark with
+                        rollback_Stack, which refuses a mark of another
+                        arena, or one the arena has been given back below
+                        since, even once allocations reach past it again
+Input:                  this_Arena: the arena in question
+                        mark: a mark from mark_Arena
+Result:                 The result of rollback_Stack, which prints the error
+                        messages
+----------------------------------------------------------------------------*/
+long pop_to_mark (Arena * this_Arena, long mark)
+{
+    return rollback_Stack (this_Arena, mark);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          push_bytes
+Purpose:                This function allocates bytes from the arena
+Description:            This function finds the first address past the
+                        memory in use that has the alignment, and checks
+                        that the padding and the bytes fit in what is left
+                        before the stack pointer is moved past them. The
+                        check subtracts from the room left rather than
+                        adding to the address, so no size can wrap around
+Input:                  this_Arena: the arena in question
+                        bytes: the number of bytes wanted
+                        align: the alignment wanted, a power of two, or 0
+Result:                 The memory allocated. NULL if the arena does not
+                        exist, the alignment is not a power of two or the
+                        arena has no room and an error message is printed
+----------------------------------------------------------------------------*/
+void * push_bytes (Arena * this_Arena, unsigned long bytes, 
+                   unsigned long align)
+{
+    char * next = 0;            /* first byte past the memory in use */
+    unsigned long room = 0;     /* bytes left in the arena */
+    unsigned long pad = 0;      /* bytes skipped for the alignment */
+    unsigned long longs = 0;    /* longs taken by the allocation */
+
+    /* If statement is executed if the arena is not yet set */
+    if (!this_Arena)
+    {
+        writeline (ARENA_NONEXIST, stderr);    /* error message printed */
+        return NULL;
+    }
+
+    /* If statement is executed if the alignment is not a power of two */
+    if ( align & (align - 1) )
+    {
+        writeline (ALIGN_INVALID, stderr);     /* error message printed */
+        return NULL;
+    }
+
+    /* the elements of a stack are already aligned to a long */
+    if (align < ARENA_ALIGN)
+    {
+        align = ARENA_ALIGN;
+    }
+
+    next = (char *)(this_Arena + this_Arena[STACK_POINTER_INDEX] + 1);
+    room = (this_Arena[STACK_SIZE_INDEX] - this_Arena[STACK_POINTER_INDEX]
+            - 1) * sizeof(long);
+    pad = -(uintptr_t)next & (align - 1);
+
+    /* If statement is executed if the allocation does not fit */
+    if (pad > room || bytes > room - pad)
+    {
+        STATS_ADD (this_Arena, STATS_PUSH_FULL, 1);
+        writeline (ARENA_FULL, stderr);        /* error message printed */
+        return NULL;
+    }
+
+    longs = (pad + bytes + sizeof(long) - 1) / sizeof(long);
+    this_Arena[STACK_POINTER_INDEX] += longs;
+    STATS_ADD (this_Arena, STATS_PUSHES, longs);
+    STATS_DEPTH (this_Arena);
+
+    /* If statement is executed when debug mode is on */
+    if (TRACING)
+    {
+        trace_record (TRACE_PUSH, this_Arena[STACK_COUNT_INDEX], bytes);
+    }
+
+    return next + pad;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          used_Arena
+Purpose:                This function reports the memory in use
+Description:            This function counts the longs on the stack in bytes
+Input:                  this_Arena: the arena in question
+Result:                 The bytes in use, or 0 if the arena does not exist
+                        and the error message of num_elements is printed
+----------------------------------------------------------------------------*/
+long used_Arena (Arena * this_Arena)
+{
+    return num_elements (this_Arena) * sizeof(long);
+}
@@ -0,0 +1,44 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "stack.h"
+
+/* An arena hands out memory for temporaries in last in, first out order.
+It is a Stack whose elements are the memory itself: push_bytes moves the
+stack pointer up past an allocation, rounded to whole longs, and
+pop_to_mark moves it back down to a mark in one step, giving back every
+allocation made since.  Since an arena is a Stack, it has the same header,
+comes from the stack pool, is counted in the statistics (stats.h), with
+pushes and pops in longs, and shows in the trace (trace.h), where each
+allocation is recorded as one push of its size in bytes and a return to a
+mark as the pops of the longs given back.  Memory given back is cleared
+when secure clearing is on. */
+
+typedef Stack Arena;
+
+#define ARENA_ALIGN sizeof(long)    /* alignment push_bytes gives by default,
+                                       and at least */
+
+void delete_Arena (Arena **);   /* deallocates the arena and all memory
+                                   handed out from it.  Assigns incoming
+                                   pointer to NULL. */
+long mark_Arena (Arena *);      /* marks the memory in use for pop_to_mark.
+                                   Result is the mark, or -1 on failure */
+Arena * new_Arena (unsigned long); /* allocates an arena of at least the
+                                   given number of bytes.  Result is the
+                                   new arena, or NULL on failure */
+long pop_to_mark (Arena *, long); /* gives back every allocation made since
+                                   the mark.  A mark of another arena, or
+                                   one given back below since, is refused.
+                                   Result is 0 or non-0 indicating failure
+                                   or success, respectively */
+void * push_bytes (Arena *, unsigned long, unsigned long); /* allocates the
+                                   number of bytes from the arena, aligned
+                                   to the power of two given last, 0
+                                   choosing ARENA_ALIGN.  Result is the
+                                   memory, or NULL if the arena has no room
+                                   for it */
+long used_Arena (Arena *);      /* returns the number of bytes in use,
+                                   alignment padding included */
+
+#endif
@@ -0,0 +1,637 @@
+/*****************************************************************************
+
+File Name:      bench.c
+Description:    This program measures the stack primitives in stack.c, the
+                scans in stackscan.c, the segmented stack in segstack.c,
+                the RPN evaluator in rpn.c, the shared lock-free stacks in
+                lfstack.c and elimstack.c and the work-stealing scheduler
+                in scheduler.c, over several stack sizes and thread counts.
+                Each benchmark is timed in rounds, and the time per
+                operation of every round is kept so that percentiles can be
+                reported.  Results are printed as CSV, one line per
+                benchmark, and can be compared against a saved run to catch
+                regressions.
+
+*****************************************************************************/
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "elimstack.h"
+#include "lfstack.h"
+#include "mylib.h"
+#include "rpn.h"
+#include "scheduler.h"
+#include "segstack.h"
+#include "stack.h"
+#include "stackscan.h"
+
+#define CHURN_OPS 1000      /* new_Stack/delete_Stack pairs per round */
+#define INLINE_CAPACITY 16  /* longs in the stacks of new_delete_inline */
+#define LEAF_WORK 64        /* generator steps in each leaf of ws_tasks */
+#define LINE_SIZE 256       /* longest line read from a baseline file */
+#define MAX_RESULTS 256     /* most results kept from a baseline file */
+#define NAME_SIZE 32        /* longest benchmark name */
+#define PAIR_OPS 1000       /* push/pop pairs per round on shared stacks */
+#define ROUND_OPS 4096      /* most operations timed in one round */
+#define ROUNDS 200          /* rounds timed per thread */
+#define RPN_TEXT "$0 $1 * $1 + $0 -"  /* program of the RPN benchmarks */
+
+/* the benchmarks, in the order they are run */
+enum { PUSH, POP, TOP, EMPTY, CHURN, CHURN_POOL, CHURN_INLINE, WRITE, FIND,
+       SEG_PUSH, SEG_POP, RPN_BATCH, RPN_CALLS, LF_PAIR, ELIM_PAIR, WS_TASKS,
+       BENCHMARKS };
+
+static const char * names[BENCHMARKS] = {
+    "push", "pop", "top", "empty_Stack", "new_delete", "new_delete_pool",
+    "new_delete_inline", "write_Stack", "find_Stack", "segstack_push",
+    "segstack_pop", "rpn_batch", "rpn_calls", "lfstack_pair", "estack_pair",
+    "ws_tasks"
+};
+
+static const unsigned long sizes[] = { 16, 1024, 65536 };
+static const long threads[] = { 1, 2, 4 };
+
+/* one line of results */
+typedef struct Result
+{
+    char name[NAME_SIZE];   /* benchmark name */
+    unsigned long size;     /* stack size */
+    long threads;           /* number of threads */
+    double p50;             /* median ns per operation */
+    double p90;             /* 90th percentile ns per operation */
+    double p99;             /* 99th percentile ns per operation */
+    double mean;            /* mean ns per operation */
+    double rate;            /* operations per second over all threads */
+} Result;
+
+/* the work given to one thread */
+typedef struct Worker
+{
+    long benchmark;         /* which benchmark to run */
+    unsigned long size;     /* stack size */
+    long rounds;            /* rounds to time */
+    double * samples;       /* ns per operation of each round */
+    long ops;               /* operations made in all rounds */
+    double busy;            /* ns spent in timed rounds */
+    LFStack * lfstack;      /* shared stack for lfstack_pair */
+    EStack * estack;        /* shared stack for estack_pair */
+    Scheduler * scheduler;  /* shared workers for ws_tasks */
+    pthread_barrier_t * start;  /* lines the threads up before timing */
+} Worker;
+
+static int compare_doubles (const void * first, const void * second);
+static long compare_results (const char * filename, Result * results,
+                             long count, double threshold);
+static double now (void);
+static void run_benchmark (long benchmark, unsigned long size, long nthreads,
+                           long rounds, Result * result);
+static void * run_worker (void * argument);
+static void split_task (Scheduler * scheduler, long leaves);
+
+
+int main (int argc, char * const * argv)
+{
+    Result results[MAX_RESULTS];    /* results of this run */
+    const char * baseline = 0;      /* file of results to compare against */
+    double threshold = 10;          /* percent slower counted as regression */
+    long rounds = ROUNDS;           /* rounds timed per thread */
+    long count = 0;                 /* number of results */
+    long benchmark = 0;             /* benchmark being run */
+    unsigned long size = 0;         /* index into sizes */
+    unsigned long nthreads = 0;     /* index into threads */
+    char option;                    /* the command line option */
+
+    /* check command line options for a baseline, threshold and quick run */
+    while ( (option = getopt (argc, argv, "c:qt:") ) != EOF )
+    {
+        switch (option)
+        {
+            case 'c': baseline = optarg;
+            break;
+
+            case 'q': rounds = ROUNDS / 10;
+            break;
+
+            case 't': threshold = atof (optarg);
+            break;
+
+            default:
+                fprintf (stderr,
+                         "usage: %s [-q] [-c baseline.csv] [-t percent]\n",
+                         argv[0]);
+                return 2;
+        }
+    }
+
+    printf ("benchmark,size,threads,p50_ns,p90_ns,p99_ns,mean_ns,ops_per_sec\n");
+
+    for (benchmark = 0; benchmark < BENCHMARKS; benchmark++)
+    {
+        for (size = 0; size < sizeof(sizes) / sizeof(*sizes); size++)
+        {
+            for (nthreads = 0; nthreads < sizeof(threads) / sizeof(*threads);
+                 nthreads++)
+            {
+                run_benchmark (benchmark, sizes[size], threads[nthreads],
+                               rounds, results + count);
+                printf ("%s,%lu,%ld,%.2f,%.2f,%.2f,%.2f,%.0f\n",
+                        results[count].name, results[count].size,
+                        results[count].threads, results[count].p50,
+                        results[count].p90, results[count].p99,
+                        results[count].mean, results[count].rate);
+                fflush (stdout);
+                count++;
+            }
+        }
+    }
+
+    /* If statement is executed when a baseline was given */
+    if (baseline)
+    {
+        return compare_results (baseline, results, count, threshold) ? 1 : 0;
+    }
+
+    return 0;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          compare_results
+Purpose:                This function compares a run against a saved baseline
+Description:            This function reads the CSV lines of the baseline and,
+                        for each benchmark, size and thread count found in
+                        both, reports the change in median ns per operation
+                        to stderr. A benchmark whose median grew by more than
+                        threshold percent is flagged as a regression
+Input:                  filename: the baseline CSV file
+                        results: the results of this run
+                        count: the number of results
+                        threshold: percent slower counted as a regression
+Result:                 The number of regressions, or 1 if the baseline
+                        cannot be read
+----------------------------------------------------------------------------*/
+static long compare_results (const char * filename, Result * results,
+                             long count, double threshold)
+{
+    FILE * stream = fopen (filename, "r");  /* the baseline file */
+    char line[LINE_SIZE];                   /* one line of the baseline */
+    Result old;                             /* one baseline result */
+    double change = 0;                      /* percent change in median */
+    long regressions = 0;                   /* benchmarks that got slower */
+    long index = 0;                         /* index into results */
+
+    /* If statement is executed if the baseline cannot be opened */
+    if (!stream)
+    {
+        fprintf (stderr, "Cannot open baseline %s\n", filename);
+        return 1;
+    }
+
+    fprintf (stderr, "%-16s %8s %7s %12s %12s %8s\n", "benchmark", "size",
+             "threads", "base_p50_ns", "p50_ns", "change");
+
+    while ( fgets (line, LINE_SIZE, stream) )
+    {
+        /* If statement is executed for the header and malformed lines */
+        if (sscanf (line, "%31[^,],%lu,%ld,%lf,%lf,%lf,%lf,%lf", old.name,
+                    &old.size, &old.threads, &old.p50, &old.p90, &old.p99,
+                    &old.mean, &old.rate) != 8)
+        {
+            continue;
+        }
+
+        for (index = 0; index < count; index++)
+        {
+            if ( !strcmp (results[index].name, old.name) &&
+                 results[index].size == old.size &&
+                 results[index].threads == old.threads )
+            {
+                change = (results[index].p50 - old.p50) * 100 / old.p50;
+                fprintf (stderr, "%-16s %8lu %7ld %12.2f %12.2f %+7.1f%%%s\n",
+                         old.name, old.size, old.threads, old.p50,
+                         results[index].p50, change,
+                         change > threshold ? "  REGRESSION" : "");
+                regressions += change > threshold;
+                break;
+            }
+        }
+    }
+
+    fclose (stream);
+    fprintf (stderr, "%ld regression(s) above %.1f%%\n", regressions,
+             threshold);
+
+    return regressions;
+}
+
+
+/* orders doubles for qsort */
+static int compare_doubles (const void * first, const void * second)
+{
+    double difference = *(const double *)first - *(const double *)second;
+
+    return (difference > 0) - (difference < 0);
+}
+
+
+/* the monotonic clock in nanoseconds */
+static double now (void)
+{
+    struct timespec time;   /* the current time */
+
+    clock_gettime (CLOCK_MONOTONIC, &time);
+
+    return time.tv_sec * 1e9 + time.tv_nsec;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          run_benchmark
+Purpose:                This function runs one benchmark on a number of
+                        threads
+Description:            This function starts one worker per thread, lines them
+                        up on a barrier and waits for them. The samples of all
+                        threads are then sorted for the percentiles, and the
+                        rates of the threads, each its operations over its
+                        time spent in timed rounds, add up to the rate.
+                        Threads use stacks of their own, except in the pair
+                        benchmarks, where they share one lock-free stack. In
+                        ws_tasks a single thread times the runs of a
+                        scheduler with nthreads workers, itself one of them
+Input:                  benchmark: which benchmark to run
+                        size: stack size
+                        nthreads: number of threads
+                        rounds: rounds timed per thread
+                        result: where the results are stored
+Result:                 The result is filled in
+----------------------------------------------------------------------------*/
+static void run_benchmark (long benchmark, unsigned long size, long nthreads,
+                           long rounds, Result * result)
+{
+    long runners = benchmark == WS_TASKS ? 1 : nthreads; /* timed threads */
+    pthread_t thread[runners];      /* the threads running workers */
+    Worker worker[runners];         /* the work of each thread */
+    pthread_barrier_t start;        /* lines the threads up */
+    double * samples = malloc (runners * rounds * sizeof(double));
+    double rate = 0;                /* operations per second, all threads */
+    double total = 0;               /* sum of all samples */
+    long count = runners * rounds;  /* number of samples */
+    long index = 0;                 /* index into threads or samples */
+    LFStack * lfstack = 0;          /* shared stack for lfstack_pair */
+    EStack * estack = 0;            /* shared stack for estack_pair */
+    Scheduler * scheduler = 0;      /* shared workers for ws_tasks */
+
+    if (benchmark == CHURN_POOL)
+    {
+        pool_on ();
+    }
+    else if (benchmark == LF_PAIR)
+    {
+        lfstack = new_LFStack (size);
+    }
+    else if (benchmark == ELIM_PAIR)
+    {
+        estack = new_EStack (size);
+    }
+    else if (benchmark == WS_TASKS)
+    {
+        scheduler = new_Scheduler (nthreads, split_task, NULL);
+    }
+
+    pthread_barrier_init (&start, NULL, runners + 1);
+
+    for (index = 0; index < runners; index++)
+    {
+        worker[index].benchmark = benchmark;
+        worker[index].size = size;
+        worker[index].rounds = rounds;
+        worker[index].samples = samples + index * rounds;
+        worker[index].ops = 0;
+        worker[index].busy = 0;
+        worker[index].lfstack = lfstack;
+        worker[index].estack = estack;
+        worker[index].scheduler = scheduler;
+        worker[index].start = &start;
+        pthread_create (thread + index, NULL, run_worker, worker + index);
+    }
+
+    pthread_barrier_wait (&start);
+
+    for (index = 0; index < runners; index++)
+    {
+        pthread_join (thread[index], NULL);
+        rate += worker[index].ops * 1e9 / worker[index].busy;
+    }
+
+    pthread_barrier_destroy (&start);
+
+    qsort (samples, count, sizeof(double), compare_doubles);
+
+    for (index = 0; index < count; index++)
+    {
+        total += samples[index];
+    }
+
+    snprintf (result->name, NAME_SIZE, "%s", names[benchmark]);
+    result->size = size;
+    result->threads = nthreads;
+    result->p50 = samples[count / 2];
+    result->p90 = samples[count * 90 / 100];
+    result->p99 = samples[count * 99 / 100];
+    result->mean = total / count;
+    result->rate = rate;
+
+    free (samples);
+    pool_off ();
+
+    if (lfstack)
+    {
+        delete_LFStack (&lfstack);
+    }
+    if (estack)
+    {
+        delete_EStack (&estack);
+    }
+    if (scheduler)
+    {
+        /* show how the last round's tasks were spread over the workers */
+        fprintf (stderr, "%s,%lu,%ld tasks per worker:", names[benchmark],
+                 size, nthreads);
+        for (index = 0; index < nthreads; index++)
+        {
+            fprintf (stderr, " %ld", ran_Scheduler (scheduler, index));
+        }
+        fprintf (stderr, "\n");
+        delete_Scheduler (&scheduler);
+    }
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          run_worker
+Purpose:                This function times the rounds of one thread
+Description:            This function sets up the thread's own stack, waits
+                        on the barrier and then runs the rounds. Anything a
+                        round needs, such as a full stack to pop from, is
+                        prepared before its clock starts. A call that works
+                        on the whole stack is repeated until the round has
+                        covered about ROUND_OPS elements, and empty_Stack is
+                        timed ROUND_OPS times on a stack made full again by
+                        its pointer, so that no round is a single short
+                        call. Each round's time is divided by its operations
+                        to give one sample
+Input:                  argument: the Worker describing the work
+Result:                 The worker's samples and operation count are filled in
+----------------------------------------------------------------------------*/
+static void * run_worker (void * argument)
+{
+    Worker * worker = argument;     /* the work of this thread */
+    unsigned long size = worker->size;  /* stack size */
+    unsigned long ops = size < ROUND_OPS ? size : ROUND_OPS; /* per round */
+    unsigned long passes = size < ROUND_OPS ? ROUND_OPS / size : 1;
+                                    /* whole-stack calls timed in a round */
+    unsigned long pass = 0;         /* whole-stack call being timed */
+    long * values = malloc (size * sizeof(long));   /* values to push */
+    Stack * this_Stack = new_Stack (size);  /* the thread's own stack */
+    SegStack * segstack = new_SegStack (0); /* its own segmented stack */
+    RPNProgram * program = compile_RPN (RPN_TEXT);  /* program to run */
+    long * results = malloc (size * sizeof(long));  /* results of runs */
+    FILE * sink = fopen ("/dev/null", "w"); /* output for write_Stack */
+    unsigned long index = 0;        /* index into a round */
+    long round = 0;                 /* round being timed */
+    long item = 0;                  /* item popped or topped */
+    double start = 0;               /* time the round started */
+    double elapsed = 0;             /* time the round took */
+
+    for (index = 0; index < size; index++)
+    {
+        values[index] = index;
+    }
+
+    pthread_barrier_wait (worker->start);
+
+    for (round = 0; round < worker->rounds; round++)
+    {
+        /* prepare the stack before the clock starts */
+        empty_Stack (this_Stack);
+        if (worker->benchmark != PUSH && worker->benchmark != RPN_BATCH &&
+            worker->benchmark != RPN_CALLS)
+        {
+            push_n (this_Stack, values, size);
+        }
+        empty_SegStack (segstack);
+        if (worker->benchmark == SEG_POP)
+        {
+            for (index = 0; index < ops; index++)
+            {
+                push_SegStack (segstack, values[index]);
+            }
+        }
+
+        start = now ();
+
+        switch (worker->benchmark)
+        {
+            case PUSH:
+                for (index = 0; index < ops; index++)
+                {
+                    push (this_Stack, values[index]);
+                }
+                break;
+
+            case POP:
+                for (index = 0; index < ops; index++)
+                {
+                    pop (this_Stack, &item);
+                }
+                break;
+
+            case TOP:
+                for (index = 0; index < ops; index++)
+                {
+                    top (this_Stack, &item);
+                }
+                break;
+
+            case EMPTY:
+                ops = ROUND_OPS;
+                for (index = 0; index < ops; index++)
+                {
+                    this_Stack[STACK_POINTER_INDEX] = size - 1;
+                    empty_Stack (this_Stack);
+                }
+                break;
+
+            case CHURN:
+            case CHURN_POOL:
+                ops = CHURN_OPS;
+                for (index = 0; index < ops; index++)
+                {
+                    Stack * churn = new_Stack (size);
+
+                    delete_Stack (&churn);
+                }
+                break;
+
+            case CHURN_INLINE:
+                ops = CHURN_OPS;
+                for (index = 0; index < ops; index++)
+                {
+                    STACK_BUFFER (INLINE_CAPACITY) buffer;
+                    Stack * churn = NEW_INLINE_STACK (buffer);
+
+                    push (churn, index);
+                    delete_Stack (&churn);
+                }
+                break;
+
+            case WRITE:
+                ops = size * passes;
+                for (pass = 0; pass < passes; pass++)
+                {
+                    write_Stack (this_Stack, sink);
+                    fflush (sink);
+                }
+                break;
+
+            case FIND:
+                ops = size * passes;
+                for (pass = 0; pass < passes; pass++)
+                {
+                    find_Stack (this_Stack, -1);
+                }
+                break;
+
+            case SEG_PUSH:
+                for (index = 0; index < ops; index++)
+                {
+                    push_SegStack (segstack, values[index]);
+                }
+                break;
+
+            case SEG_POP:
+                for (index = 0; index < ops; index++)
+                {
+                    pop_SegStack (segstack, &item);
+                }
+                break;
+
+            case RPN_BATCH:
+                ops = size / 2 * passes;
+                for (pass = 0; pass < passes; pass++)
+                {
+                    run_batch_RPN (program, this_Stack, values, size / 2,
+                                   results);
+                }
+                break;
+
+            case RPN_CALLS:
+                ops = size / 2 * passes;
+                for (pass = 0; pass < passes; pass++)
+                {
+                    for (index = 0; index < size / 2; index++)
+                    {
+                        long first = 0;     /* value below the top */
+                        long second = 0;    /* value on top */
+
+                        push (this_Stack, values[2 * index]);
+                        push (this_Stack, values[2 * index + 1]);
+                        pop (this_Stack, &second);
+                        pop (this_Stack, &first);
+                        push (this_Stack, first * second);
+                        push (this_Stack, values[2 * index + 1]);
+                        pop (this_Stack, &second);
+                        pop (this_Stack, &first);
+                        push (this_Stack, first + second);
+                        push (this_Stack, values[2 * index]);
+                        pop (this_Stack, &second);
+                        pop (this_Stack, &first);
+                        push (this_Stack, first - second);
+                        pop (this_Stack, &results[index]);
+                    }
+                }
+                break;
+
+            case LF_PAIR:
+                ops = PAIR_OPS * 2;
+                for (index = 0; index < PAIR_OPS; index++)
+                {
+                    push_LFStack (worker->lfstack, index);
+                    pop_LFStack (worker->lfstack, &item);
+                }
+                break;
+
+            case ELIM_PAIR:
+                ops = PAIR_OPS * 2;
+                for (index = 0; index < PAIR_OPS; index++)
+                {
+                    push_EStack (worker->estack, index);
+                    pop_EStack (worker->estack, &item);
+                }
+                break;
+
+            case WS_TASKS:
+                ops = size * 2 - 1;
+                run_Scheduler (worker->scheduler, size);
+                break;
+        }
+
+        elapsed = now () - start;
+        worker->samples[round] = elapsed / ops;
+        worker->busy += elapsed;
+        worker->ops += ops;
+    }
+
+    fclose (sink);
+    delete_Stack (&this_Stack);
+    delete_SegStack (&segstack);
+    delete_RPN (&program);
+    free (results);
+    pool_trim ();   /* the pool is per thread and this thread is ending */
+    free (values);
+
+    return NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          split_task
+Purpose:                This function is the task of the ws_tasks benchmark
+Description:            This function splits a range of leaves in two halves
+                        and spawns a task for each, until a single leaf is
+                        left, which steps a generator LEAF_WORK times. A run
+                        over size leaves is 2 * size - 1 tasks, all of them
+                        spawned from the first, so the other workers only get
+                        work by stealing it
+Input:                  scheduler: the scheduler running the task
+                        leaves: the number of leaves below this task
+Result:                 The halves are spawned or the leaf's work is done
+----------------------------------------------------------------------------*/
+static void split_task (Scheduler * scheduler, long leaves)
+{
+    volatile unsigned long sink = 0;    /* keeps the leaf's work */
+    unsigned long seed = leaves | 1;    /* generator state */
+    long step = 0;                      /* generator step */
+
+    /* If statement is executed if the leaves can still be split */
+    if (leaves > 1)
+    {
+        spawn_Scheduler (scheduler, leaves / 2);
+        spawn_Scheduler (scheduler, leaves - leaves / 2);
+        return;
+    }
+
+    for (step = 0; step < LEAF_WORK; step++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+    }
+
+    sink = seed;
+    (void)sink;
+}
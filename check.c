@@ -0,0 +1,254 @@
+/*****************************************************************************
+
+File Name:      check.c
+Description:    This program checks that rollback_Stack refuses every mark
+                it should, calling mark_Stack and rollback_Stack directly:
+                marks the stack has since been rolled back, emptied or
+                popped below, and marks of other stacks, while nested marks
+                stay good.  The same is checked of pop_to_mark in arena.c.
+                Each failed check is printed, and the program exits
+                non-zero if any failed.
+
+*****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "arena.h"
+#include "mylib.h"
+#include "stack.h"
+
+#define ARENA_BYTES 256     /* bytes in the arenas checked */
+#define CHECK_SIZE 8        /* elements in the stacks checked */
+#define FOREIGN_STACKS 70000 /* stacks made between a mark and its misuse */
+#define FRAMES 100          /* marks nested in the frames check */
+
+static long failures = 0;   /* number of checks failed */
+
+static void check (long passed, const char * what);
+static void check_arena (void);
+static void check_empty (void);
+static void check_foreign (void);
+static void check_frames (void);
+static void check_nested (void);
+static void check_pop_below (void);
+static void check_rollback (void);
+
+
+int main (void)
+{
+    check_rollback ();
+    check_empty ();
+    check_pop_below ();
+    check_foreign ();
+    check_nested ();
+    check_frames ();
+    check_arena ();
+
+    /* If statement is executed if every check passed */
+    if (!failures)
+    {
+        printf ("check passed\n");
+        return 0;
+    }
+
+    printf ("%ld checks failed\n", failures);
+    return 1;
+}
+
+
+/* counts and prints a check that did not pass */
+static void check (long passed, const char * what)
+{
+    /* If statement is executed if the check failed */
+    if (!passed)
+    {
+        printf ("failed: %s\n", what);
+        failures++;
+    }
+}
+
+
+/* pop_to_mark refuses marks given back already or of another arena, and
+ * keeps outer marks good */
+static void check_arena (void)
+{
+    Arena * this_Arena = new_Arena (ARENA_BYTES);   /* the arena checked */
+    Arena * other = new_Arena (ARENA_BYTES);        /* another arena */
+    long outer = 0;         /* mark with nothing in use */
+    long inner = 0;         /* mark after one allocation */
+
+    outer = mark_Arena (this_Arena);
+    push_bytes (this_Arena, 24, 0);
+    inner = mark_Arena (this_Arena);
+    push_bytes (this_Arena, 40, 0);
+    check (pop_to_mark (this_Arena, inner), "inner arena mark");
+    push_bytes (this_Arena, 8, 0);
+    check (pop_to_mark (this_Arena, outer), "outer arena mark after inner");
+    check (used_Arena (this_Arena) == 0, "outer arena mark frees all");
+
+    push_bytes (this_Arena, 16, 0);
+    push_bytes (this_Arena, 16, 0);
+    check (!pop_to_mark (this_Arena, inner), "arena mark given back");
+    check (used_Arena (this_Arena) == 32, "refused pop_to_mark left it");
+    check (!pop_to_mark (other, outer), "mark of another arena");
+
+    delete_Arena (&other);
+    delete_Arena (&this_Arena);
+}
+
+
+/* a mark taken before empty_Stack is refused once pushed back above */
+static void check_empty (void)
+{
+    Stack * this_Stack = new_Stack (CHECK_SIZE);    /* the stack checked */
+    long mark = 0;          /* mark taken before emptying */
+
+    push (this_Stack, 5);
+    mark = mark_Stack (this_Stack);
+    empty_Stack (this_Stack);
+    push (this_Stack, 6);
+    push (this_Stack, 7);
+    check (!rollback_Stack (this_Stack, mark), "mark before an empty");
+    check (num_elements (this_Stack) == 2, "refused rollback left it alone");
+
+    delete_Stack (&this_Stack);
+}
+
+
+/* a mark is refused by every other stack, however many come after it */
+static void check_foreign (void)
+{
+    Stack * owner = new_Stack (CHECK_SIZE);     /* stack marked */
+    Stack * other = new_Stack (CHECK_SIZE);     /* stack misusing the mark */
+    Stack * churn = 0;      /* stacks made in between */
+    long mark = 0;          /* mark of owner */
+    long count = 0;         /* stacks made so far */
+
+    mark = mark_Stack (owner);
+    check (!rollback_Stack (other, mark), "mark of another stack");
+    check (!rollback_Stack (other, mark_Stack (other) + 1),
+           "unknown mark");
+
+    for (count = 0; count < FOREIGN_STACKS; count++)
+    {
+        churn = new_Stack (CHECK_SIZE);
+        mark_Stack (churn);
+        delete_Stack (&churn);
+    }
+
+    churn = new_Stack (CHECK_SIZE);
+    check (!rollback_Stack (churn, mark), "mark of a much older stack");
+    push (owner, 1);
+    check (rollback_Stack (owner, mark), "mark still good on its stack");
+
+    delete_Stack (&churn);
+    delete_Stack (&other);
+    delete_Stack (&owner);
+}
+
+
+/* marks taken frame by frame all roll back, innermost first */
+static void check_frames (void)
+{
+    Stack * this_Stack = new_Stack (FRAMES);    /* the stack checked */
+    long marks[FRAMES];     /* mark of each frame */
+    long frame = 0;         /* frame being entered or left */
+    long good = TRUE;       /* whether every rollback succeeded */
+
+    for (frame = 0; frame < FRAMES; frame++)
+    {
+        marks[frame] = mark_Stack (this_Stack);
+        push (this_Stack, frame);
+    }
+
+    for (frame = FRAMES - 1; frame >= 0; frame--)
+    {
+        good = rollback_Stack (this_Stack, marks[frame]) &&
+               num_elements (this_Stack) == frame && good;
+    }
+    check (good, "frames roll back innermost first");
+
+    delete_Stack (&this_Stack);
+}
+
+
+/* rolling back to an inner mark keeps the outer marks good */
+static void check_nested (void)
+{
+    Stack * this_Stack = new_Stack (CHECK_SIZE);    /* the stack checked */
+    long outer = 0;         /* mark at depth 0 */
+    long inner = 0;         /* mark at depth 1 */
+    long later = 0;         /* mark at depth 1 after a pop below inner */
+    long item = 0;          /* value popped */
+
+    outer = mark_Stack (this_Stack);
+    push (this_Stack, 1);
+    inner = mark_Stack (this_Stack);
+    check (mark_Stack (this_Stack) == inner, "same depth, same mark");
+    push (this_Stack, 2);
+    check (rollback_Stack (this_Stack, inner), "inner mark");
+    check (rollback_Stack (this_Stack, inner), "inner mark again");
+    push (this_Stack, 3);
+    check (rollback_Stack (this_Stack, outer), "outer after inner");
+    check (num_elements (this_Stack) == 0, "outer mark depth");
+
+    push (this_Stack, 4);
+    inner = mark_Stack (this_Stack);
+    pop (this_Stack, &item);
+    push (this_Stack, 5);
+    later = mark_Stack (this_Stack);
+    check (later != inner, "new mark after a pop below");
+    check (!rollback_Stack (this_Stack, inner), "mark popped below");
+    check (rollback_Stack (this_Stack, later), "mark after the pop");
+
+    delete_Stack (&this_Stack);
+}
+
+
+/* a mark the stack has been popped below is refused, by pop or pop_n */
+static void check_pop_below (void)
+{
+    Stack * this_Stack = new_Stack (CHECK_SIZE);    /* the stack checked */
+    long items[CHECK_SIZE]; /* values popped */
+    long mark = 0;          /* mark at depth 3 */
+
+    push (this_Stack, 1);
+    push (this_Stack, 2);
+    push (this_Stack, 3);
+    mark = mark_Stack (this_Stack);
+    pop (this_Stack, items);
+    pop (this_Stack, items);
+    push (this_Stack, 9);
+    push (this_Stack, 9);
+    check (!rollback_Stack (this_Stack, mark), "mark popped below");
+
+    mark = mark_Stack (this_Stack);
+    pop_n (this_Stack, items, 2);
+    push (this_Stack, 9);
+    push (this_Stack, 9);
+    push (this_Stack, 9);
+    check (!rollback_Stack (this_Stack, mark), "mark pop_n went below");
+
+    delete_Stack (&this_Stack);
+}
+
+
+/* a mark the stack has been rolled back below is refused */
+static void check_rollback (void)
+{
+    Stack * this_Stack = new_Stack (CHECK_SIZE);    /* the stack checked */
+    long first = 0;         /* mark at depth 0 */
+    long second = 0;        /* mark at depth 1 */
+
+    first = mark_Stack (this_Stack);
+    push (this_Stack, 1);
+    second = mark_Stack (this_Stack);
+    push (this_Stack, 2);
+    check (rollback_Stack (this_Stack, first), "first mark");
+    push (this_Stack, 3);
+    push (this_Stack, 4);
+    check (!rollback_Stack (this_Stack, second), "mark rolled back below");
+    check (num_elements (this_Stack) == 2, "refused rollback left it alone");
+
+    delete_Stack (&this_Stack);
+}
@@ -6,171 +6,895 @@ Description:    This program allows us to test the code that we have written
 
 *****************************************************************************/
 
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
 #include "mylib.h"
+#include "registry.h"
+#include "ring.h"
 #include "stack.h"
+#include "stats.h"
+#include "trace.h"
 
-int main (int argc, char * const * argv) 
+#define BATCH_BUFFER (1 << 16)  /* bytes buffered on input and output in
+                                   batch mode */
+#define LINE_SIZE 256           /* longest input line kept, the rest of a
+                                   longer line is discarded */
+#define PIPE_BATCH 1024         /* commands or replies passed at once
+                                   between the pipelined threads */
+#define PIPE_RING 64            /* batches waiting between two threads */
+#define PIPE_SPINS 64           /* tries at a full or empty ring before
+                                   the thread starts sleeping */
+#define PIPE_SLEEP 50000        /* ns slept between later tries */
+
+/* what the executor has to say about a command, printed by print_reply */
+enum { REPLY_HANDLE, REPLY_DELETED, REPLY_EMPTIED, REPLY_FULL,
+       REPLY_NOT_FULL, REPLY_EMPTY, REPLY_NOT_EMPTY, REPLY_LISTED,
+       REPLY_MARK, REPLY_COUNT, REPLY_POPPED, REPLY_USES, REPLY_FAILURES,
+       REPLY_SIZES, REPLY_TOP, REPLY_CONTENTS };
+
+/* One command as read from the input.  The argument is only read for the
+ * commands that take one, and valid says whether it was a number. */
+typedef struct Command
 {
-    Stack * main_Stack = 0;         /* the test stack */
-    unsigned long amount;        /* numbers of items possible go on stack */
-    long command;                   /* stack command entered by user */
-    long item = 0;                  /* item to go on stack */
+    long command;               /* the command letter */
+    long argument;              /* the number given with the command */
+    long valid;                 /* whether the number could be read */
+} Command;
+
+/* One piece of output, kept as numbers so that the executor only decides
+ * what is said and print_reply writes the text. */
+typedef struct Reply
+{
+    long message;               /* which REPLY_ is said */
+    long values[3];             /* the numbers it says */
+    char * text;                /* malloc'd text of REPLY_CONTENTS, or 0 */
+} Reply;
+
+/* a batch of commands, from the reader to the executor */
+typedef struct CommandBatch
+{
+    long count;                 /* commands in the batch */
+    Command commands[PIPE_BATCH];   /* the commands */
+} CommandBatch;
+
+/* a batch of replies, from the executor to the writer */
+typedef struct ReplyBatch
+{
+    long count;                 /* replies in the batch */
+    Reply replies[PIPE_BATCH];  /* the replies */
+} ReplyBatch;
+
+/* What the executor keeps between commands.  The rings and the batch of
+ * replies are only used in pipelined mode, where a reply is collected
+ * instead of printed at once. */
+typedef struct Session
+{
+    Stack * main_Stack;         /* the selected test stack */
+    long handle;                /* handle of the selected stack */
+    long batch;                 /* whether prompts are turned off */
+    long debug;                 /* whether debug messages are shown */
+    Ring * commands;            /* batches from the reader */
+    Ring * replies;             /* batches to the writer */
+    ReplyBatch * outgoing;      /* replies not yet passed to the writer */
+} Session;
+
+static void emit (Session * session, long message, long first,
+                  long second, long third, char * text);
+static void execute_command (Session * session, const Command * command);
+static void pass (Ring * ring, void * item);
+static void pass_replies (Session * session);
+static void print_reply (const Reply * reply);
+static long read_command (Command * command, long batch);
+static long read_line (char * line);
+static long run_pipeline (Session * session);
+static void * run_reader (void * argument);
+static void * run_writer (void * argument);
+static void * take (Ring * ring);
+
+int main (int argc, char * const * argv)
+{
+    Session session = { 0 };        /* the stacks and how to report */
+    Stack * main_Stack = 0;         /* a stack being deallocated */
+    long handle = 0;                /* handle of that stack */
+    Command command;                /* the command entered by user */
     char option;                    /* the command line option */
-    long status;                    /* return status of stack functions */
-        
+    long pipelined = FALSE;         /* whether to run three threads */
+    const char * script = 0;        /* file to read commands from */
+
     /* initialize debug states */
     debug_off ();
 
-    /* check command line options for debug display */
-    while ( (option = getopt (argc, argv, "x") ) != EOF ) 
+    /* check command line options for debug display, batch mode, a
+     * command file and pipelined mode */
+    while ( (option = getopt (argc, argv, "bf:px") ) != EOF )
     {
-        switch (option) 
+        switch (option)
         {
-            case 'x': debug_on (); 
+            case 'b': session.batch = TRUE;
+            break;
+
+            case 'f': script = optarg;
+                      session.batch = TRUE;
+            break;
+
+            case 'p': pipelined = TRUE;
+                      session.batch = TRUE;
+            break;
+
+            case 'x': debug_on ();
+                      session.debug = TRUE;
             break;
         }
     }
 
-    while (1) 
+    /* If statement is executed when commands come from a file */
+    if ( script && !freopen (script, "r", stdin) )
+    {
+        fprintf (stderr, "Cannot open command file %s\n", script);
+        return 1;
+    }
+
+    /* If statement is executed in batch mode, where input is read and
+     * output is written in large chunks instead of line by line */
+    if (session.batch)
+    {
+        setvbuf (stdin, NULL, _IOFBF, BATCH_BUFFER);
+        setvbuf (stdout, NULL, _IOFBF, BATCH_BUFFER);
+    }
+
+    /* If statement is executed in pipelined mode, where reading,
+     * executing and printing each have a thread */
+    if (pipelined)
     {
-        command = 0;            /* initialize command, need for loops */
-        writeline ("\nPlease enter a command:", stdout);
-        writeline ("\n\t(a)llocate, (d)eallocate, ", stdout);
-        writeline ("p(u)sh, (p)op, (t)op, (i)sempty, (e)mpty, ",stdout);
-        writeline ("\n\tis(f)ull, (n)um_elements,", stdout);
-        writeline (" (w)rite to stdout, (W)rite to stderr.\n", stdout);
-        writeline ("Please enter choice:  ", stdout);
-        command = getchar ();
-        if (command == EOF)     /* are we done? */
+        /* If statement is executed if the threads could not be started */
+        if ( !run_pipeline (&session) )
         {
-            break;
+            fprintf (stderr, "Cannot start the pipelined threads\n");
+            return 1;
         }
-        clrbuf (command);       /* get rid of extra characters */
-
-        switch (command)       /* process commands */
+    }
+    else
+    {
+        while (1)
         {
-            case 'a':               /* allocate */
-                writeline ("\nPlease enter the number of objects to", stdout);
-                writeline (" be able to store: ", stdout);
-                amount = decin ();
-                
-                /* If statement executed when stack already exists */
-                if (main_Stack)
-                {
-                    delete_Stack (&main_Stack);     /* deletes stack */
-                }
+            if (!session.batch)
+            {
+                writeline ("\nPlease enter a command:", stdout);
+                writeline ("\n\t(a)llocate, (d)eallocate, (h)andle select, ",
+                           stdout);
+                writeline ("(l)ist,\n\t(m)ark, (r)ollback, ", stdout);
+                writeline ("p(u)sh, (p)op, (t)op, (i)sempty, (e)mpty, ",
+                           stdout);
+                writeline ("\n\tis(f)ull, (n)um_elements, (s)tatistics,",
+                           stdout);
+                writeline ("\n\t(w)rite to stdout, (W)rite to stderr.\n",
+                           stdout);
+                writeline ("Please enter choice:  ", stdout);
+            }
+            if ( !read_command (&command, session.batch) ) /* are we done? */
+            {
+                break;
+            }
 
-                main_Stack = new_Stack (amount);    /* creates a new stack */
+            execute_command (&session, &command);
+        }
+    }
+
+    /* deallocate every stack still in the registry */
+    while ( (handle = next_Registry (0)) )
+    {
+        main_Stack = remove_Registry (handle);
+        delete_Stack (&main_Stack);
+    }
+    if (session.debug)
+    {
+        trace_dump (stderr);
+    }
+    newline ();
+    return 0;
+}
 
-                clrbuf (amount + ' ');
-                break;
 
-            case 'd':               /* deallocate */
-                /* deallocated memory from the stack */
-                delete_Stack(&main_Stack);  
+/*----------------------------------------------------------------------------
+Function Name:          emit
+Purpose:                This function reports what a command did
+Description:            This function prints the reply straight away when
+                        the commands are run one at a time. In pipelined
+                        mode it adds the reply to the batch for the writer,
+                        passing the batch on when it is full
+Input:                  session: the executor's state
+                        message: which REPLY_ is said
+                        first, second, third: the numbers it says
+                        text: malloc'd text of REPLY_CONTENTS, or 0
+Result:                 The reply is printed or queued
+----------------------------------------------------------------------------*/
+static void emit (Session * session, long message, long first,
+                  long second, long third, char * text)
+{
+    Reply reply = { message, { first, second, third }, text }; /* reply */
 
-                writeline ("Stack has been deleted\n", stdout);
+    /* If statement is executed when commands are run one at a time */
+    if (!session->replies)
+    {
+        print_reply (&reply);
+        free (text);
+        return;
+    }
+
+    session->outgoing->replies[session->outgoing->count++] = reply;
+
+    /* If statement is executed if the batch is full */
+    if (session->outgoing->count == PIPE_BATCH)
+    {
+        pass_replies (session);
+    }
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          execute_command
+Purpose:                This function carries out one command on the stacks
+Description:            This function applies the command to the selected
+                        stack, or to the registry, and emits what there is
+                        to say about it. Failures are warned about on stderr
+                        straight away. In debug mode the trace is dumped
+                        after the command
+Input:                  session: the executor's state
+                        command: the command read
+Result:                 The command is carried out
+----------------------------------------------------------------------------*/
+static void execute_command (Session * session, const Command * command)
+{
+    long item = 0;                  /* item taken off the stack */
+    long other = 0;                 /* handle of another stack */
+    StackStats stats;               /* statistics of the stack */
+    char * text = 0;                /* contents of the stack */
+    size_t length = 0;              /* length of the contents */
+    FILE * stream = 0;              /* the contents being written */
+
+    switch (command->command)       /* process commands */
+    {
+        case 'a':               /* allocate */
+            /* If statement executed when no size was entered */
+            if ( !command->valid || command->argument < 0 )
+            {
+                fprintf (stderr,"\nWARNING:  invalid size\n");
                 break;
+            }
 
-            case 'e':               /* empty */
-                empty_Stack (main_Stack);      /* empties stack */
+            /* creates a new stack, watched so that s can show its own
+             * counters, and selects it, earlier stacks are kept under
+             * their handles */
+            session->main_Stack = new_Stack (command->argument);
+            session->handle = session->main_Stack && 
+                              stats_watch (session->main_Stack) ?
+                              add_Registry (session->main_Stack) : 0;
 
-                writeline ("Stack is empty.\n", stdout);
-                break;    
+            /* If statement executed when the stack got no handle */
+            if (session->main_Stack && !session->handle)
+            {
+                delete_Stack (&session->main_Stack);
+            }
+            if (session->main_Stack)
+            {
+                emit (session, REPLY_HANDLE, session->handle, 0, 0, 0);
+            }
+            break;
 
-            case 'f':               /* isfull */
-                if ( isfull_Stack (main_Stack) )
-                {
-                    writeline ("Stack is full.\n",stdout);
-                }
-                else
-                {
-                    writeline ("Stack is not full.\n", stdout);
-                }
+        case 'd':               /* deallocate */
+            /* If statement executed when a stack is selected */
+            if (session->handle)
+            {
+                remove_Registry (session->handle);
+                session->handle = 0;
+            }
+
+            /* deallocated memory from the stack */
+            delete_Stack (&session->main_Stack);
+
+            emit (session, REPLY_DELETED, 0, 0, 0, 0);
+            break;
+
+        case 'e':               /* empty */
+            empty_Stack (session->main_Stack);      /* empties stack */
+
+            emit (session, REPLY_EMPTIED, 0, 0, 0, 0);
+            break;
+
+        case 'f':               /* isfull */
+            emit (session, isfull_Stack (session->main_Stack) ?
+                  REPLY_FULL : REPLY_NOT_FULL, 0, 0, 0, 0);
+            break;
+
+        case 'h':               /* select by handle */
+            /* If statement executed when the handle names no stack */
+            if ( !command->valid || !find_Registry (command->argument) )
+            {
+                fprintf (stderr,"\nWARNING:  invalid handle\n");
                 break;
+            }
+            session->handle = command->argument;
+            session->main_Stack = find_Registry (session->handle);
+            break;
 
-            case 'i':               /* isempty */
-                if ( isempty_Stack (main_Stack) )
-                {
-                    writeline ("Stack is empty.\n", stdout);
-                }
-                else
-                {
-                    writeline ("Stack is not empty.\n", stdout);
-                }
+        case 'i':               /* isempty */
+            emit (session, isempty_Stack (session->main_Stack) ?
+                  REPLY_EMPTY : REPLY_NOT_EMPTY, 0, 0, 0, 0);
+            break;
+
+        case 'l':               /* list */
+            for (other = next_Registry (0); other;
+                 other = next_Registry (other))
+            {
+                emit (session, REPLY_LISTED, other,
+                      num_elements (find_Registry (other)),
+                      other == session->handle, 0);
+            }
+            break;
+
+        case 'm':               /* mark */
+            item = mark_Stack (session->main_Stack);
+            if (item >= 0)
+            {
+                emit (session, REPLY_MARK, item, 0, 0, 0);
+            }
+            break;
+
+        case 'n':               /* num_elements */
+            emit (session, REPLY_COUNT, num_elements (session->main_Stack),
+                  0, 0, 0);
+            break;
+
+        case 'p':               /* pop */
+            if ( !pop (session->main_Stack, &item) )
+            {
+                fprintf (stderr,"\nWARNING:  pop FAILED\n");
+            }
+            else
+            {
+                emit (session, REPLY_POPPED, item, 0, 0, 0);
+            }
+            break;
+
+        case 'r':               /* rollback */
+            /* If statement executed when no mark was entered */
+            if (!command->valid)
+            {
+                fprintf (stderr,"\nWARNING:  invalid mark\n");
                 break;
+            }
+            if ( !rollback_Stack (session->main_Stack, command->argument) )
+            {
+                fprintf (stderr,"\nWARNING:  rollback FAILED\n");
+            }
+            break;
 
-            case 'n':               /* num_elements */
-                writeline ("Number of elements on the stack is:  ", stdout);
-                decout ( num_elements (main_Stack) );
-                newline ();
+        case 's':               /* statistics */
+            if ( stats_Stack (session->main_Stack, &stats) )
+            {
+                emit (session, REPLY_USES, stats.pushes, stats.pops,
+                      stats.tops, 0);
+                emit (session, REPLY_FAILURES, stats.push_full,
+                      stats.pop_empty, stats.top_empty, 0);
+                emit (session, REPLY_SIZES, stats.max_depth, stats.size,
+                      stats.reserved, 0);
+            }
+            break;
+
+        case 't':               /* top */
+            if ( !top (session->main_Stack, &item) )
+            {
+                fprintf (stderr,"\nWARNING:  top FAILED\n");
+            }
+            else
+            {
+                emit (session, REPLY_TOP, item, 0, 0, 0);
+            }
+            break;
+
+        case 'u':               /* push */
+            /* If statement executed when no number was entered, or a
+             * negative one, which push and write_Stack keep for EOF and
+             * characters */
+            if ( !command->valid || command->argument < 0 )
+            {
+                fprintf (stderr,"\nWARNING:  invalid number\n");
                 break;
+            }
+            if (push (session->main_Stack, command->argument) != 1)
+            {
+                fprintf(stderr,"\nWARNING:  push FAILED\n");
+            }
+            break;
 
-            case 'p':               /* pop */
-                status = pop (main_Stack, &item);
-                if (! status)
-                {
-                    fprintf (stderr,"\nWARNING:  pop FAILED\n");
-                }
-                else 
-                {
-                    writeline ("Number popped from the stack is:  ", stdout);
-                    decout (item);
-                    newline ();
-                }
+        case 'w':               /* write */
+            /* If statement executed when commands are run one at a time,
+             * when the stack is written straight to stdout */
+            if (!session->replies)
+            {
+                writeline ("\nThe Stack contains:\n", stdout);
+                write_Stack (session->main_Stack, stdout);
                 break;
+            }
 
-            case 't':               /* top */
-                status = top (main_Stack, &item);
-                if (! status)
-                {
-                    fprintf (stderr,"\nWARNING:  top FAILED\n");
-                }
-                else 
+            /* the contents are written to memory for the writer thread */
+            stream = open_memstream (&text, &length);
+            if (stream)
+            {
+                write_Stack (session->main_Stack, stream);
+                fclose (stream);
+            }
+            emit (session, REPLY_CONTENTS, 0, 0, 0, text);
+            break;
+
+        case 'W':               /* write */
+            emit (session, REPLY_CONTENTS, 0, 0, 0, 0);
+            write_Stack (session->main_Stack, stderr);
+            break;
+    }
+
+    if (session->debug)      /* show what the command did to the stack */
+    {
+        trace_dump (stderr);
+    }
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          pass
+Purpose:                This function puts a batch in a ring, waiting for
+                        room
+Description:            This function tries the ring PIPE_SPINS times,
+                        yielding the processor in between, and then sleeps
+                        PIPE_SLEEP ns between tries, so a thread waiting on
+                        a slower one does not keep a core busy
+Input:                  ring: the ring the batch goes to
+                        item: the batch, or NULL at the end of the input
+Result:                 The batch is in the ring
+----------------------------------------------------------------------------*/
+static void pass (Ring * ring, void * item)
+{
+    struct timespec pause = { 0, PIPE_SLEEP }; /* time slept between tries */
+    long tries = 0;             /* tries made so far */
+
+    while ( !put_Ring (ring, item) )
+    {
+        if (++tries < PIPE_SPINS)
+        {
+            sched_yield ();
+        }
+        else
+        {
+            nanosleep (&pause, NULL);
+        }
+    }
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          pass_replies
+Purpose:                This function hands the executor's replies to the
+                        writer
+Description:            This function passes the batch of replies being
+                        filled to the writer and starts a new one. The
+                        program stops if no new batch can be allocated,
+                        since the output would no longer match the input
+Input:                  session: the executor's state
+Result:                 The batch is with the writer and an empty one is
+                        being filled
+----------------------------------------------------------------------------*/
+static void pass_replies (Session * session)
+{
+    pass (session->replies, session->outgoing);
+    session->outgoing = malloc (sizeof(ReplyBatch));
+
+    /* If statement is executed if no batch is left to fill */
+    if (!session->outgoing)
+    {
+        fprintf (stderr, "\nWARNING:  replies lost\n");
+        exit (1);
+    }
+    session->outgoing->count = 0;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          print_reply
+Purpose:                This function prints what a command did
+Description:            This function writes the text of the reply to
+                        stdout, with its numbers in their places
+Input:                  reply: the reply being printed
+Result:                 The reply is printed
+----------------------------------------------------------------------------*/
+static void print_reply (const Reply * reply)
+{
+    switch (reply->message)
+    {
+        case REPLY_HANDLE:
+            writeline ("Stack handle is:  ", stdout);
+            decout (reply->values[0]);
+            newline ();
+            break;
+
+        case REPLY_DELETED:
+            writeline ("Stack has been deleted\n", stdout);
+            break;
+
+        case REPLY_EMPTIED:
+        case REPLY_EMPTY:
+            writeline ("Stack is empty.\n", stdout);
+            break;
+
+        case REPLY_FULL:
+            writeline ("Stack is full.\n",stdout);
+            break;
+
+        case REPLY_NOT_FULL:
+            writeline ("Stack is not full.\n", stdout);
+            break;
+
+        case REPLY_NOT_EMPTY:
+            writeline ("Stack is not empty.\n", stdout);
+            break;
+
+        case REPLY_LISTED:
+            writeline ("Stack ", stdout);
+            decout (reply->values[0]);
+            writeline (" has ", stdout);
+            decout (reply->values[1]);
+            writeline (" elements", stdout);
+            writeline (reply->values[2] ? " (selected)\n" : "\n", stdout);
+            break;
+
+        case REPLY_MARK:
+            writeline ("Stack mark is:  ", stdout);
+            decout (reply->values[0]);
+            newline ();
+            break;
+
+        case REPLY_COUNT:
+            writeline ("Number of elements on the stack is:  ", stdout);
+            decout (reply->values[0]);
+            newline ();
+            break;
+
+        case REPLY_POPPED:
+            writeline ("Number popped from the stack is:  ", stdout);
+            decout (reply->values[0]);
+            newline ();
+            break;
+
+        case REPLY_USES:
+            writeline ("Pushes, pops and tops:  ", stdout);
+            decout (reply->values[0]);
+            writeline (" ", stdout);
+            decout (reply->values[1]);
+            writeline (" ", stdout);
+            decout (reply->values[2]);
+            break;
+
+        case REPLY_FAILURES:
+            writeline ("\nFull pushes, empty pops and tops:  ", stdout);
+            decout (reply->values[0]);
+            writeline (" ", stdout);
+            decout (reply->values[1]);
+            writeline (" ", stdout);
+            decout (reply->values[2]);
+            break;
+
+        case REPLY_SIZES:
+            writeline ("\nMost elements held out of the size:  ", stdout);
+            decout (reply->values[0]);
+            writeline (" ", stdout);
+            decout (reply->values[1]);
+            writeline ("\nBytes reserved:  ", stdout);
+            decout (reply->values[2]);
+            newline ();
+            break;
+
+        case REPLY_TOP:
+            writeline ("Number at top of the stack is:  ", stdout);
+            decout (reply->values[0]);
+            newline ();
+            break;
+
+        case REPLY_CONTENTS:
+            writeline ("\nThe Stack contains:\n", stdout);
+            if (reply->text)
+            {
+                writeline (reply->text, stdout);
+            }
+            break;
+    }
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          read_command
+Purpose:                This function reads one command
+Description:            This function reads the command letter from a line
+                        of input and, for the commands that take a number,
+                        prompts for it unless in batch mode and reads it
+                        from the next line
+Input:                  command: the command read
+                        batch: whether prompts are turned off
+Result:                 True if a command was read, false at the end of
+                        input
+----------------------------------------------------------------------------*/
+static long read_command (Command * command, long batch)
+{
+    char line[LINE_SIZE];           /* one line of input */
+    const char * prompt = 0;        /* prompt for the number, if any */
+
+    /* If statement is executed at the end of input */
+    if ( !read_line (line) )
+    {
+        return 0;
+    }
+    command->command = line[0];
+    command->valid = FALSE;
+
+    switch (command->command)
+    {
+        case 'a':
+            prompt = "\nPlease enter the number of objects to"
+                     " be able to store: ";
+            break;
+
+        case 'h':
+            prompt = "\nPlease enter the handle of a stack:  ";
+            break;
+
+        case 'r':
+            prompt = "\nPlease enter a mark of the stack:  ";
+            break;
+
+        case 'u':
+            prompt = "\nPlease enter a number to push to stack:  ";
+            break;
+
+        default:
+            return 1;
+    }
+
+    if (!batch)
+    {
+        writeline (prompt, stdout);
+    }
+
+    /* If statement is executed if the input ends before the number */
+    if ( !read_line (line) )
+    {
+        return 0;
+    }
+    command->valid = sdecin (line, &command->argument);
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          read_line
+Purpose:                This function reads one line of input
+Description:            This function reads a whole line from stdin into the
+                        line buffer with one call, instead of a character at
+                        a time. If the line is longer than the buffer, the
+                        rest of it is discarded
+Input:                  line: buffer of LINE_SIZE characters for the line
+Result:                 True if a line was read, false at the end of input
+----------------------------------------------------------------------------*/
+static long read_line (char * line)
+{
+    /* If statement is executed at the end of input */
+    if ( !fgets (line, LINE_SIZE, stdin) )
+    {
+        return 0;
+    }
+
+    /* If statement is executed if the line did not fit in the buffer */
+    if ( !strchr (line, '\n') )
+    {
+        clrbuf (0);     /* get rid of extra characters */
+    }
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          run_pipeline
+Purpose:                This function runs the commands on three threads
+Description:            This function starts a reader thread, which parses
+                        the input into batches of commands, and a writer
+                        thread, which prints batches of replies, and joins
+                        them by rings to this thread, which executes the
+                        commands in between. Each ring has one thread
+                        putting and one getting, and NULL marks the end.
+                        Each batch of commands is answered by a batch of
+                        replies, so the output keeps up with the input
+Input:                  session: the executor's state
+Result:                 True once every command was executed and its output
+                        printed. False if the threads could not be started
+----------------------------------------------------------------------------*/
+static long run_pipeline (Session * session)
+{
+    pthread_t reader;               /* thread parsing the input */
+    pthread_t writer;               /* thread printing the output */
+    CommandBatch * incoming = 0;    /* batch being executed */
+    long index = 0;                 /* command being executed */
+    long status = 0;                /* whether the threads ran */
+
+    session->commands = new_Ring (PIPE_RING);
+    session->replies = new_Ring (PIPE_RING);
+    session->outgoing = malloc (sizeof(ReplyBatch));
+
+    /* If statement is executed if the rings and threads could all be made,
+     * the reader only being started once the writer is */
+    if ( session->commands && session->replies && session->outgoing &&
+         !pthread_create (&writer, NULL, run_writer, session->replies) )
+    {
+        session->outgoing->count = 0;
+
+        if ( !pthread_create (&reader, NULL, run_reader, session->commands) )
+        {
+            while ( (incoming = take (session->commands)) )
+            {
+                for (index = 0; index < incoming->count; index++)
                 {
-                    writeline ("Number at top of the stack is:  ", stdout);
-                    decout (item);
-                    newline ();
+                    execute_command (session, &incoming->commands[index]);
                 }
-                break;
+                free (incoming);
 
-            case 'u':               /* push */
-                writeline ("\nPlease enter a number to push to stack:  ",
-                           stdout);
-                item = decin ();
-                clrbuf (0);     /* get rid of extra characters */
-                status = push (main_Stack, item);
-                if (! status)
+                /* If statement is executed if the batch had any output */
+                if (session->outgoing->count)
                 {
-                    fprintf(stderr,"\nWARNING:  push FAILED\n");
+                    pass_replies (session);
                 }
-                break;
+            }
 
-            case 'w':               /* write */
-                writeline ("\nThe Stack contains:\n", stdout);
-                write_Stack (main_Stack, stdout);
-                break;
+            pthread_join (reader, NULL);
+            status = 1;
+        }
 
-            case 'W':               /* write */
-                writeline ("\nThe Stack contains:\n", stdout);
-                write_Stack (main_Stack, stderr);
+        pass (session->replies, NULL);
+        pthread_join (writer, NULL);
+    }
+
+    free (session->outgoing);
+    session->outgoing = 0;
+    if (session->commands)
+    {
+        delete_Ring (&session->commands);
+    }
+    if (session->replies)
+    {
+        delete_Ring (&session->replies);
+    }
+
+    return status;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          run_reader
+Purpose:                This function is the reader thread of pipelined mode
+Description:            This function reads commands into batches and passes
+                        each batch on when it is full, and the last one and
+                        then NULL at the end of the input
+Input:                  argument: the ring to the executor
+Result:                 NULL once the input is used up
+----------------------------------------------------------------------------*/
+static void * run_reader (void * argument)
+{
+    Ring * ring = argument;         /* ring to the executor */
+    CommandBatch * batch = 0;       /* batch being filled */
+    long more = TRUE;               /* whether input is left */
+
+    while (more)
+    {
+        batch = malloc (sizeof(CommandBatch));
+
+        /* If statement is executed if no batch could be made */
+        if (!batch)
+        {
+            fprintf (stderr, "\nWARNING:  commands lost\n");
+            break;
+        }
+
+        for (batch->count = 0; batch->count < PIPE_BATCH; batch->count++)
+        {
+            /* If statement is executed at the end of input */
+            if ( !read_command (&batch->commands[batch->count], TRUE) )
+            {
+                more = FALSE;
                 break;
+            }
+        }
+
+        pass (ring, batch);
+    }
+
+    pass (ring, NULL);
+
+    return NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          run_writer
+Purpose:                This function is the writer thread of pipelined mode
+Description:            This function prints every reply of each batch it
+                        is passed, until it is passed NULL. stdout is only
+                        flushed when no batch is waiting, so a long stream
+                        of output is written in large chunks
+Input:                  argument: the ring from the executor
+Result:                 NULL once the executor is done
+----------------------------------------------------------------------------*/
+static void * run_writer (void * argument)
+{
+    Ring * ring = argument;         /* ring from the executor */
+    ReplyBatch * batch = 0;         /* batch being printed */
+    void * item = 0;                /* what the ring held */
+    long index = 0;                 /* reply being printed */
+
+    while (1)
+    {
+        /* If statement is executed if no batch is waiting, when what was
+         * printed so far is let out before waiting */
+        if ( !get_Ring (ring, &item) )
+        {
+            fflush (stdout);
+            item = take (ring);
         }
 
-        if (item == EOF) /* check if done */
+        /* If statement is executed at the end of the output */
+        if ( !(batch = item) )
         {
             break;
         }
+
+        for (index = 0; index < batch->count; index++)
+        {
+            print_reply (&batch->replies[index]);
+            free (batch->replies[index].text);
+        }
+        free (batch);
     }
 
-    if (main_Stack)
+    return NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          take
+Purpose:                This function gets a batch from a ring, waiting for
+                        one
+Description:            This function waits on the ring as pass does
+Input:                  ring: the ring the batch comes from
+Result:                 The batch, or NULL at the end of the input
+----------------------------------------------------------------------------*/
+static void * take (Ring * ring)
+{
+    struct timespec pause = { 0, PIPE_SLEEP }; /* time slept between tries */
+    long tries = 0;             /* tries made so far */
+    void * item = 0;            /* the batch */
+
+    while ( !get_Ring (ring, &item) )
     {
-        delete_Stack (&main_Stack);     /* deallocate stack */
+        if (++tries < PIPE_SPINS)
+        {
+            sched_yield ();
+        }
+        else
+        {
+            nanosleep (&pause, NULL);
+        }
     }
-    newline ();
-    return 0;
-}
 
+    return item;
+}
@@ -0,0 +1,411 @@
+/******************************************************************************
+
+File Name:      elimstack.c
+Description:    This program implements an elimination-backoff stack of longs
+                on top of the lock-free stack in lfstack.c.  Pushes and pops
+                that collide on the top of the stack meet in an array of
+                exchange slots, where a push hands its value straight to a
+                pop, so throughput keeps growing with the number of threads
+                instead of being limited by one contended cache line.
+
+******************************************************************************/
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "elimstack.h"
+#include "lfstack.h"
+#include "mylib.h"
+
+#define CACHE_LINE 64           /* bytes in a cache line */
+#define ELIM_SPINS 256          /* checks a waiting push makes on its slot */
+
+/* A slot's state holds its kind in the low two bits and a sequence number
+ * above them.  The sequence changes whenever a push claims the slot, so a
+ * pop cannot take a value that was replaced after it read the slot. */
+#define SLOT_FREE 0             /* nobody is using the slot */
+#define SLOT_CLAIMED 1          /* a push is writing its value */
+#define SLOT_OFFER 2            /* a push is waiting with its value */
+#define SLOT_TAKEN 3            /* a pop has taken the value */
+#define SLOT_KIND(state) ((state) & 3UL)
+#define SLOT_SEQ(state) ((state) & ~3UL)
+#define SLOT_NEXT 4UL           /* one step of the sequence number */
+
+/* catastrophic error messages */
+static const char ALLOCATE_FAILED[] = 
+                        "Allocating an elimination stack failed!!!\n";
+static const char DELETE_NONEXIST[] = "Deleting a non-existent stack!!!\n";
+static const char ISEMPTY_NONEXIST[] = 
+                        "Isempty check from a non-existent stack!!!\n";
+static const char ISFULL_NONEXIST[] = 
+                        "Isfull check from a non-existent stack!!!\n";
+static const char POP_NONEXIST[] = "Popping from a non-existent stack!!!\n";
+static const char PUSH_NONEXIST[] = "Pushing to a non-existent stack!!!\n";
+static const char TOP_NONEXIST[] = "Topping from a non-existent stack!!!\n";
+
+/* each exchange slot is on its own cache line */
+typedef struct ESlot 
+{
+    _Alignas (CACHE_LINE) _Atomic unsigned long state; /* kind and sequence */
+    _Atomic long value;                 /* value offered by a push */
+} ESlot;
+
+struct EStack 
+{
+    LFStack * stack;            /* the shared lock-free stack */
+    ESlot * slots;              /* the elimination array */
+    unsigned long width;        /* number of slots in the array */
+};
+
+static long offer_value (EStack * this_Stack, long item);
+static unsigned long pick_slot (EStack * this_Stack);
+static long take_value (EStack * this_Stack, long * item);
+
+
+/*----------------------------------------------------------------------------
+Function Name:          delete_EStack
+Purpose:                This function deletes a created elimination stack
+Description:            This function checks to see if the stack exists. If
+                        not, an error message is printed. If so, the lock-free
+                        stack, the slots and the stack itself are deallocated
+                        and the caller's pointer is set to NULL
+Input:                  spp: the stack from which we will deallocate memory
+Result:                 Deletes the created stack or prints an error message
+----------------------------------------------------------------------------*/
+void delete_EStack (EStack ** spp) 
+{
+    /* If statement is executed if spp or the stack it points to does not
+     * exist */
+    if (!spp || !*spp)
+    {
+        writeline (DELETE_NONEXIST, stderr);   /* error message printed */
+        return;
+    }
+
+    delete_LFStack (&(*spp)->stack);
+    free ((*spp)->slots);
+    free (*spp);
+    *spp = NULL;
+}
+
+
+/* Empty and full checks only look at the shared stack, since a value in a
+ * slot is in the middle of being handed over. */
+long isempty_EStack (EStack * this_Stack) 
+{
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (ISEMPTY_NONEXIST, stderr);      /* error message printed */
+        return 1;
+    }
+
+    return isempty_LFStack (this_Stack->stack);
+}
+
+
+long isfull_EStack (EStack * this_Stack) 
+{
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (ISFULL_NONEXIST, stderr);   /* error message printed */
+        return 0;
+    }
+
+    return isfull_LFStack (this_Stack->stack);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          new_EStack
+Purpose:                This function allocates an elimination stack able to
+                        hold stacksize longs
+Description:            This function allocates the lock-free stack that holds
+                        the elements and one exchange slot per online
+                        processor, each on its own cache line and initially
+                        free
+Input:                  stacksize: number of longs the stack can hold
+Result:                 A pointer to the new stack, or NULL if memory could
+                        not be allocated and an error message is printed
+----------------------------------------------------------------------------*/
+EStack * new_EStack (unsigned long stacksize) 
+{
+    EStack * this_Stack = 0;    /* the stack being created */
+    long processors = 0;        /* number of online processors */
+    unsigned long index = 0;    /* index of the slot being set up */
+
+    this_Stack = malloc (sizeof(EStack));
+
+    /* If statement is executed if the stack could not be allocated */
+    if (!this_Stack)
+    {
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    processors = sysconf (_SC_NPROCESSORS_ONLN);
+    this_Stack->width = processors > 0 ? processors : 1;
+    this_Stack->slots = aligned_alloc (CACHE_LINE, 
+                                       this_Stack->width * sizeof(ESlot));
+    this_Stack->stack = new_LFStack (stacksize);
+
+    /* If statement is executed if the parts could not be allocated */
+    if (!this_Stack->slots || !this_Stack->stack)
+    {
+        free (this_Stack->slots);
+        if (this_Stack->stack)
+        {
+            delete_LFStack (&this_Stack->stack);
+        }
+        free (this_Stack);
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    for (index = 0; index < this_Stack->width; index++)
+    {
+        atomic_init (&this_Stack->slots[index].state, SLOT_FREE);
+        atomic_init (&this_Stack->slots[index].value, 0);
+    }
+
+    return this_Stack;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          pop_EStack
+Purpose:                This function removes the top item in the stack
+Description:            This function makes one attempt to pop the shared
+                        stack. When the attempt loses a race, it looks in a
+                        random slot for a waiting push and takes its value,
+                        then tries the shared stack again if there was none
+Input:                  this_Stack: the stack from which we are getting our
+                                    items
+                        item: the number we will remove from the stack
+Result:                 True if an item was removed. False if the stack is
+                        empty, or if the stack does not exist and an error
+                        message is printed
+----------------------------------------------------------------------------*/
+long pop_EStack (EStack * this_Stack, long * item) 
+{
+    long status = 0;            /* result of the last attempt */
+
+    /* If statement is executed when the stack has not been set yet */
+    if (!this_Stack)
+    {
+        writeline (POP_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    while ( (status = trypop_LFStack (this_Stack->stack, item)) == LF_BUSY )
+    {
+        /* If statement is executed if a waiting push handed over its value */
+        if ( take_value (this_Stack, item) )
+        {
+            return 1;
+        }
+    }
+
+    return status;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          push_EStack
+Purpose:                This function adds a new element to the top of stack
+Description:            This function first checks for EOF, as push does, then
+                        makes one attempt to push the shared stack. When the
+                        attempt loses a race, it offers the item in a random
+                        slot for a while, then tries the shared stack again
+                        if no pop took it
+Input:                  this_Stack: the stack in question
+                        item: the long being stored to the top of stack
+Result:                 True if the item was pushed or handed to a pop, false
+                        if the stack is full, false with an error message if
+                        the stack does not exist, and EOF for our ^D test
+----------------------------------------------------------------------------*/
+long push_EStack (EStack * this_Stack, long item) 
+{
+    long status = 0;            /* result of the last attempt */
+
+    /* If statement is executed when EOF is reached */
+    if (item == EOF)
+    {
+        return EOF;
+    }
+
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (PUSH_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    while ( (status = trypush_LFStack (this_Stack->stack, item)) == LF_BUSY )
+    {
+        /* If statement is executed if a pop took the item from a slot */
+        if ( offer_value (this_Stack, item) )
+        {
+            return 1;
+        }
+    }
+
+    return status;
+}
+
+
+/* Topping only reads the shared stack, so it never needs to back off. */
+long top_EStack (EStack * this_Stack, long * item) 
+{
+    /* If statement is executed when the stack has not been set yet */
+    if (!this_Stack)
+    {
+        writeline (TOP_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    return top_LFStack (this_Stack->stack, item);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          offer_value
+Purpose:                This function waits in a slot for a pop to take a value
+Description:            This function claims a random free slot, stores the
+                        value and marks the slot as an offer. It then watches
+                        the slot for ELIM_SPINS checks. If a pop took the
+                        value the slot is freed and the push is done. If not,
+                        the offer is withdrawn with a compare-and-swap, which
+                        only fails when a pop took the value at the last
+                        moment
+Input:                  this_Stack: the stack in question
+                        item: the long being offered
+Result:                 True if a pop took the value, false if the slot was
+                        busy or no pop came
+----------------------------------------------------------------------------*/
+static long offer_value (EStack * this_Stack, long item) 
+{
+    ESlot * slot = this_Stack->slots + pick_slot (this_Stack);
+    unsigned long state = 0;    /* state of the slot when it was read */
+    unsigned long seq = 0;      /* sequence number of this offer */
+    long spins = 0;             /* checks made on the slot so far */
+
+    state = atomic_load_explicit (&slot->state, memory_order_relaxed);
+
+    /* If statement is executed if the slot is busy or another push got to
+     * the slot first */
+    if ( SLOT_KIND (state) != SLOT_FREE ||
+         !atomic_compare_exchange_strong_explicit (&slot->state, &state,
+                SLOT_SEQ (state) + SLOT_NEXT + SLOT_CLAIMED,
+                memory_order_acquire, memory_order_relaxed) )
+    {
+        return 0;
+    }
+
+    seq = SLOT_SEQ (state) + SLOT_NEXT;
+    atomic_store_explicit (&slot->value, item, memory_order_relaxed);
+    atomic_store_explicit (&slot->state, seq + SLOT_OFFER, 
+                           memory_order_release);
+
+    for (spins = 0; spins < ELIM_SPINS; spins++)
+    {
+        /* If statement is executed if a pop took the value */
+        if (atomic_load_explicit (&slot->state, memory_order_acquire) 
+            == seq + SLOT_TAKEN)
+        {
+            atomic_store_explicit (&slot->state, seq + SLOT_FREE,
+                                   memory_order_release);
+            return 1;
+        }
+    }
+
+    state = seq + SLOT_OFFER;
+
+    /* If statement is executed if the offer was withdrawn before any pop
+     * took the value */
+    if ( atomic_compare_exchange_strong_explicit (&slot->state, &state,
+                seq + SLOT_FREE, memory_order_acquire, memory_order_relaxed) )
+    {
+        return 0;
+    }
+
+    /* a pop took the value while the offer was being withdrawn */
+    atomic_store_explicit (&slot->state, seq + SLOT_FREE, 
+                           memory_order_release);
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          pick_slot
+Purpose:                This function chooses a slot for a thread to back off
+                        into
+Description:            This function steps a per-thread xorshift generator,
+                        seeded from the address of the thread's own state, so
+                        threads spread over the slots without sharing any
+                        memory to do it
+Input:                  this_Stack: the stack in question
+Result:                 An index into the slots of the stack
+----------------------------------------------------------------------------*/
+static unsigned long pick_slot (EStack * this_Stack) 
+{
+    static _Thread_local unsigned long seed = 0;  /* generator state */
+
+    /* If statement is executed the first time a thread picks a slot */
+    if (!seed)
+    {
+        seed = (unsigned long)&seed | 1;
+    }
+
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+
+    return seed % this_Stack->width;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          take_value
+Purpose:                This function takes a value offered by a waiting push
+Description:            This function reads a random slot. If it holds an
+                        offer, the value is read and the slot is marked as
+                        taken with a compare-and-swap on the same state, so
+                        the value cannot have been replaced in between
+Input:                  this_Stack: the stack in question
+                        item: the value taken
+Result:                 True if a value was taken, false if the slot held no
+                        offer or another pop took it first
+----------------------------------------------------------------------------*/
+static long take_value (EStack * this_Stack, long * item) 
+{
+    ESlot * slot = this_Stack->slots + pick_slot (this_Stack);
+    unsigned long state = 0;    /* state of the slot when it was read */
+    long value = 0;             /* value read from the slot */
+
+    state = atomic_load_explicit (&slot->state, memory_order_acquire);
+
+    /* If statement is executed if no push is waiting in the slot */
+    if (SLOT_KIND (state) != SLOT_OFFER)
+    {
+        return 0;
+    }
+
+    value = atomic_load_explicit (&slot->value, memory_order_relaxed);
+
+    /* If statement is executed if another pop took the value or the push
+     * withdrew it first */
+    if ( !atomic_compare_exchange_strong_explicit (&slot->state, &state,
+                SLOT_SEQ (state) + SLOT_TAKEN,
+                memory_order_acq_rel, memory_order_relaxed) )
+    {
+        return 0;
+    }
+
+    *item = value;
+
+    return 1;
+}
@@ -0,0 +1,37 @@
+#ifndef ELIMSTACK_H
+#define ELIMSTACK_H
+
+/* This elimination-backoff stack puts an array of exchange slots in front
+of a lock-free stack (lfstack.h).  A push or pop first makes one attempt on
+the shared top of the stack.  When that attempt loses a race, the thread
+backs off into a random slot instead of retrying at once: a waiting push
+offers its value there and a pop that finds the offer takes the value
+directly, so the pair cancels out without touching the top of the stack. */
+
+typedef struct EStack EStack;
+
+void delete_EStack (EStack **); /* deallocates memory allocated in
+                                   new_EStack.  No other thread may be using
+                                   the stack.  Assigns incoming pointer to
+                                   NULL. */
+long isempty_EStack (EStack *); /* returns 0 or non-0 value indicating
+                                   whether or not the stack is empty */
+long isfull_EStack (EStack *);  /* returns 0 or non-0 value indicating
+                                   whether or not the stack is full */
+EStack * new_EStack (unsigned long); /* allocates the stack with one
+                                   elimination slot per online processor.
+                                   Result is the new stack, or NULL if
+                                   memory could not be allocated */
+long pop_EStack (EStack *, long *); /* removes and sends back the top
+                                   element of the stack.  Result is 0 or
+                                   non-0, indicating failure or success,
+                                   respectively */
+long push_EStack (EStack *, long); /* places one value on the stack.
+                                   Result is 0 or non-0 indicating failure
+                                   or success, respectively */
+long top_EStack (EStack *, long *); /* sends back the top element of the
+                                   stack.  Stack is left unaffected.  Result
+                                   is 0 or non-0 indicating failure or
+                                   success, respectively. */
+
+#endif
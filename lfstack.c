@@ -0,0 +1,616 @@
+/******************************************************************************
+
+File Name:      lfstack.c
+Description:    This program implements a lock-free stack of longs that can
+                be pushed to, popped from and topped by many threads at once
+                without a mutex.  Elements live in a pool of nodes allocated
+                with the stack, and both the stack and the pool's free list
+                are Treiber stacks of tagged node indices, which protects
+                them against the ABA problem without hazard pointers.
+
+******************************************************************************/
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "lfstack.h"
+#include "mylib.h"
+
+#define CACHE_LINE 64                   /* bytes in a cache line */
+#define LINK_MASK 0xFFFFFFFFUL          /* node index + 1, 0 is no node */
+#define TAG_ONE (LINK_MASK + 1)         /* one step of the ABA tag */
+#define MAX_NODES (LINK_MASK - 1)       /* largest pool that can be linked */
+
+/* catastrophic error messages */
+static const char ALLOCATE_FAILED[] = 
+                        "Allocating a lock-free stack failed!!!\n";
+static const char DELETE_NONEXIST[] = "Deleting a non-existent stack!!!\n";
+static const char INCOMING_NONEXIST[] = 
+                        "Incoming parameter does not exist!!!\n";
+static const char ISEMPTY_NONEXIST[] = 
+                        "Isempty check from a non-existent stack!!!\n";
+static const char ISFULL_NONEXIST[] = 
+                        "Isfull check from a non-existent stack!!!\n";
+static const char POP_NONEXIST[] = "Popping from a non-existent stack!!!\n";
+static const char PUSH_NONEXIST[] = "Pushing to a non-existent stack!!!\n";
+static const char TOP_NONEXIST[] = "Topping from a non-existent stack!!!\n";
+
+/* A node holds one element and the link to the node below it.  Both are
+ * atomic since a thread may read a node that another thread is reusing;
+ * the tag check makes such a thread retry and discard what it read. */
+typedef struct LFNode 
+{
+    _Atomic long value;                 /* the element stored */
+    _Atomic unsigned long next;         /* link to the node below */
+} LFNode;
+
+/* The top of the stack and the free list are each kept on their own cache
+ * line so that pushers and poppers do not also fight over the fields that
+ * never change. */
+struct LFStack 
+{
+    _Alignas (CACHE_LINE) LFNode * nodes;   /* the pool of nodes */
+    unsigned long size;                     /* number of nodes in the pool */
+    _Alignas (CACHE_LINE) _Atomic unsigned long top; /* tagged top link */
+    _Alignas (CACHE_LINE) _Atomic unsigned long free; /* tagged free link */
+};
+
+static void give_node (_Atomic unsigned long * list, LFNode * nodes, 
+                       unsigned long link);
+static unsigned long take_node (_Atomic unsigned long * list, 
+                                LFNode * nodes);
+static long try_give_node (_Atomic unsigned long * list, LFNode * nodes, 
+                           unsigned long link);
+static long try_take_node (_Atomic unsigned long * list, LFNode * nodes,
+                           unsigned long * link);
+
+
+/*----------------------------------------------------------------------------
+Function Name:          delete_LFStack
+Purpose:                This function deletes a created lock-free stack
+Description:            This function checks to see if the stack exists. If
+                        not, an error message is printed. If so, the pool of
+                        nodes and the stack itself are deallocated and the
+                        caller's pointer is set to NULL. The caller must make
+                        sure no other thread is still using the stack
+Input:                  spp: the stack from which we will deallocate memory
+Result:                 Deletes the created stack or prints an error message
+----------------------------------------------------------------------------*/
+void delete_LFStack (LFStack ** spp) 
+{
+    /* If statement is executed if spp or the stack it points to does not
+     * exist */
+    if (!spp || !*spp)
+    {
+        writeline (DELETE_NONEXIST, stderr);   /* error message printed */
+        return;
+    }
+
+    free ((*spp)->nodes);
+    free (*spp);
+    *spp = NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          isempty_LFStack
+Purpose:                This function checks to see if the stack is empty
+Description:            This function reads the top link of the stack. Since
+                        other threads may push or pop at the same time, the
+                        answer only describes the moment the link was read
+Input:                  this_Stack: the stack being checked
+Result:                 True if the stack is empty, false if it is not, and
+                        true with an error message if the stack does not exist
+----------------------------------------------------------------------------*/
+long isempty_LFStack (LFStack * this_Stack) 
+{
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (ISEMPTY_NONEXIST, stderr);      /* error message printed */
+        return 1;
+    }
+
+    return !(atomic_load_explicit (&this_Stack->top, memory_order_acquire)
+             & LINK_MASK);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          isfull_LFStack
+Purpose:                This function checks to see if the stack is full
+Description:            This function reads the free list of the node pool.
+                        The stack is full when no free node is left. Since
+                        other threads may push or pop at the same time, the
+                        answer only describes the moment the link was read
+Input:                  this_Stack: the stack being checked
+Result:                 True if the stack is full, false if it is not or an
+                        error occurs, and an error message prints if the
+                        stack does not exist
+----------------------------------------------------------------------------*/
+long isfull_LFStack (LFStack * this_Stack) 
+{
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (ISFULL_NONEXIST, stderr);   /* error message printed */
+        return 0;
+    }
+
+    return !(atomic_load_explicit (&this_Stack->free, memory_order_acquire)
+             & LINK_MASK);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          new_LFStack
+Purpose:                This function allocates a lock-free stack able to hold
+                        stacksize longs
+Description:            This function allocates the stack on its own cache
+                        lines and a pool of stacksize nodes. Every node is
+                        linked onto the free list and the stack starts empty
+Input:                  stacksize: number of longs the stack can hold
+Result:                 A pointer to the new stack, or NULL if the size is
+                        too large or memory could not be allocated and an
+                        error message is printed
+----------------------------------------------------------------------------*/
+LFStack * new_LFStack (unsigned long stacksize) 
+{
+    LFStack * this_Stack = 0;   /* the stack being created */
+    unsigned long index = 0;    /* index of the node being linked */
+
+    /* If statement is executed if the pool cannot be linked by index */
+    if (stacksize > MAX_NODES)
+    {
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    this_Stack = aligned_alloc (CACHE_LINE, sizeof(LFStack));
+
+    /* If statement is executed if the stack could not be allocated */
+    if (!this_Stack)
+    {
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    this_Stack->nodes = malloc ( (stacksize ? stacksize : 1) * 
+                                 sizeof(LFNode) );
+
+    /* If statement is executed if the pool could not be allocated */
+    if (!this_Stack->nodes)
+    {
+        free (this_Stack);
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    /* link every node to the one after it, the last node ends the list */
+    for (index = 0; index < stacksize; index++)
+    {
+        atomic_init (&this_Stack->nodes[index].value, 0);
+        atomic_init (&this_Stack->nodes[index].next, 
+                     index + 1 < stacksize ? index + 2 : 0);
+    }
+
+    this_Stack->size = stacksize;
+    atomic_init (&this_Stack->top, 0);
+    atomic_init (&this_Stack->free, stacksize ? 1 : 0);
+
+    return this_Stack;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          pop_LFStack
+Purpose:                This function removes the top item in the stack
+Description:            This function unlinks the top node of the stack with a
+                        compare-and-swap, reads the item out of it and returns
+                        the node to the free list. An empty stack is an
+                        expected state when many threads share the stack, so
+                        it is reported only through the result
+Input:                  this_Stack: the stack from which we are getting our
+                                    items
+                        item: the number we will remove from the stack
+Result:                 True if the removal of the top item was a success.
+                        False if the stack is empty, or if the stack or item
+                        does not exist and an error message is printed
+----------------------------------------------------------------------------*/
+long pop_LFStack (LFStack * this_Stack, long * item) 
+{
+    unsigned long link = 0;     /* link to the node being removed */
+
+    /* If statement is executed when the stack has not been set yet */
+    if (!this_Stack)
+    {
+        writeline (POP_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed when the item has not been set yet */
+    if (!item)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    link = take_node (&this_Stack->top, this_Stack->nodes);
+
+    /* If statement is executed when the stack is empty */
+    if (!link)
+    {
+        return 0;
+    }
+
+    /* the node now belongs to this thread until it is given back */
+    *item = atomic_load_explicit (&this_Stack->nodes[link - 1].value,
+                                  memory_order_relaxed);
+    give_node (&this_Stack->free, this_Stack->nodes, link);
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          push_LFStack
+Purpose:                This function adds a new element to the top of stack
+Description:            This function first checks for EOF, as push does, then
+                        takes a node from the free list, stores the item in it
+                        and links it on top of the stack with a
+                        compare-and-swap. A full stack is reported only
+                        through the result
+Input:                  this_Stack: the stack in question
+                        item: the long being stored to the top of stack
+Result:                 True if the push can be made, false if the stack is
+                        full, false with an error message if the stack does
+                        not exist, and EOF for our ^D test
+----------------------------------------------------------------------------*/
+long push_LFStack (LFStack * this_Stack, long item) 
+{
+    unsigned long link = 0;     /* link to the node being added */
+
+    /* If statement is executed when EOF is reached */
+    if (item == EOF)
+    {
+        return EOF;
+    }
+
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (PUSH_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    link = take_node (&this_Stack->free, this_Stack->nodes);
+
+    /* If statement is executed if the stack is full */
+    if (!link)
+    {
+        return 0;
+    }
+
+    atomic_store_explicit (&this_Stack->nodes[link - 1].value, item,
+                           memory_order_relaxed);
+    give_node (&this_Stack->top, this_Stack->nodes, link);
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          top_LFStack
+Purpose:                This function sends back the top element in the stack
+Description:            This function reads the top link, reads the item from
+                        the node it names and then reads the top link again.
+                        If the link, tag included, has not changed then the
+                        node was not reused in between and the item is the
+                        top of the stack. Otherwise the read is retried
+Input:                  this_Stack: the stack from which we are getting our
+                                    items
+                        item: the number on top of the stack
+Result:                 True if there is a top item in the stack. False if 
+                        the stack is empty, or if the stack or item does not
+                        exist and an error message is printed
+----------------------------------------------------------------------------*/
+long top_LFStack (LFStack * this_Stack, long * item) 
+{
+    unsigned long old = 0;      /* tagged top link when the read began */
+    long value = 0;             /* item read from the top node */
+
+    /* If statement is executed when the stack has not been set yet */
+    if (!this_Stack)
+    {
+        writeline (TOP_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed when the item has not been set yet */
+    if (!item)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    do
+    {
+        old = atomic_load_explicit (&this_Stack->top, memory_order_acquire);
+
+        /* If statement is executed when the stack is empty */
+        if ( !(old & LINK_MASK) )
+        {
+            return 0;
+        }
+
+        value = atomic_load_explicit (
+                    &this_Stack->nodes[(old & LINK_MASK) - 1].value,
+                    memory_order_relaxed);
+
+        /* keep the read of the item ahead of the second read of the top */
+        atomic_thread_fence (memory_order_acquire);
+    }
+    while (atomic_load_explicit (&this_Stack->top, memory_order_relaxed) 
+           != old);
+
+    *item = value;
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          trypop_LFStack
+Purpose:                This function makes a single attempt to remove the top
+                        item in the stack
+Description:            This function works like pop_LFStack, except that it
+                        does not retry when another thread changes the top of
+                        the stack between the read and the compare-and-swap.
+                        It lets a caller back off from a contended stack
+Input:                  this_Stack: the stack from which we are getting our
+                                    items
+                        item: the number we will remove from the stack
+Result:                 True if the removal of the top item was a success.
+                        LF_BUSY if the attempt lost a race with another
+                        thread. False if the stack is empty, or if the stack
+                        or item does not exist and an error message is printed
+----------------------------------------------------------------------------*/
+long trypop_LFStack (LFStack * this_Stack, long * item) 
+{
+    unsigned long link = 0;     /* link to the node being removed */
+    long status = 0;            /* result of the attempt */
+
+    /* If statement is executed when the stack has not been set yet */
+    if (!this_Stack)
+    {
+        writeline (POP_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed when the item has not been set yet */
+    if (!item)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    status = try_take_node (&this_Stack->top, this_Stack->nodes, &link);
+
+    /* If statement is executed when the stack is empty or contended */
+    if (status != 1)
+    {
+        return status;
+    }
+
+    *item = atomic_load_explicit (&this_Stack->nodes[link - 1].value,
+                                  memory_order_relaxed);
+    give_node (&this_Stack->free, this_Stack->nodes, link);
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          trypush_LFStack
+Purpose:                This function makes a single attempt to add a new
+                        element to the top of the stack
+Description:            This function works like push_LFStack, except that it
+                        does not retry when another thread changes the top of
+                        the stack between the read and the compare-and-swap.
+                        In that case the node is returned to the free list
+Input:                  this_Stack: the stack in question
+                        item: the long being stored to the top of stack
+Result:                 True if the push was made. LF_BUSY if the attempt
+                        lost a race with another thread. False if the stack
+                        is full, false with an error message if the stack
+                        does not exist, and EOF for our ^D test
+----------------------------------------------------------------------------*/
+long trypush_LFStack (LFStack * this_Stack, long item) 
+{
+    unsigned long link = 0;     /* link to the node being added */
+
+    /* If statement is executed when EOF is reached */
+    if (item == EOF)
+    {
+        return EOF;
+    }
+
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (PUSH_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    link = take_node (&this_Stack->free, this_Stack->nodes);
+
+    /* If statement is executed if the stack is full */
+    if (!link)
+    {
+        return 0;
+    }
+
+    atomic_store_explicit (&this_Stack->nodes[link - 1].value, item,
+                           memory_order_relaxed);
+
+    /* If statement is executed if another thread changed the top first */
+    if (try_give_node (&this_Stack->top, this_Stack->nodes, link) != 1)
+    {
+        give_node (&this_Stack->free, this_Stack->nodes, link);
+        return LF_BUSY;
+    }
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          give_node
+Purpose:                This function links a node onto the top of a list
+Description:            This function points the node at the current first
+                        node of the list, then swings the list to the node
+                        with a compare-and-swap that also bumps the tag,
+                        retrying if another thread changed the list first
+Input:                  list: the tagged link of the list
+                        nodes: the pool of nodes
+                        link: the link of the node being added
+Result:                 The node is the first node of the list
+----------------------------------------------------------------------------*/
+static void give_node (_Atomic unsigned long * list, LFNode * nodes, 
+                       unsigned long link) 
+{
+    unsigned long old = 0;      /* tagged link before the change */
+    unsigned long new = 0;      /* tagged link after the change */
+
+    old = atomic_load_explicit (list, memory_order_relaxed);
+
+    do
+    {
+        atomic_store_explicit (&nodes[link - 1].next, old & LINK_MASK,
+                               memory_order_relaxed);
+        new = link | ( (old & ~LINK_MASK) + TAG_ONE );
+    }
+    while ( !atomic_compare_exchange_weak_explicit (list, &old, new,
+                memory_order_release, memory_order_relaxed) );
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          take_node
+Purpose:                This function unlinks the first node of a list
+Description:            This function reads the first node of the list and
+                        the node below it, then swings the list to the node
+                        below with a compare-and-swap that also bumps the tag.
+                        If another thread removed and re-added the first node
+                        in between, the tag no longer matches and the swap
+                        is retried with fresh values
+Input:                  list: the tagged link of the list
+                        nodes: the pool of nodes
+Result:                 The link of the node removed, or 0 if the list is
+                        empty
+----------------------------------------------------------------------------*/
+static unsigned long take_node (_Atomic unsigned long * list, 
+                                LFNode * nodes) 
+{
+    unsigned long old = 0;      /* tagged link before the change */
+    unsigned long new = 0;      /* tagged link after the change */
+    unsigned long next = 0;     /* link of the node below the first */
+
+    old = atomic_load_explicit (list, memory_order_acquire);
+
+    do
+    {
+        /* If statement is executed when the list is empty */
+        if ( !(old & LINK_MASK) )
+        {
+            return 0;
+        }
+
+        next = atomic_load_explicit (&nodes[(old & LINK_MASK) - 1].next,
+                                     memory_order_relaxed);
+        new = next | ( (old & ~LINK_MASK) + TAG_ONE );
+    }
+    while ( !atomic_compare_exchange_weak_explicit (list, &old, new,
+                memory_order_acquire, memory_order_acquire) );
+
+    return old & LINK_MASK;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          try_give_node
+Purpose:                This function makes a single attempt to link a node
+                        onto the top of a list
+Description:            This function works like give_node but gives up
+                        instead of retrying when the compare-and-swap fails
+Input:                  list: the tagged link of the list
+                        nodes: the pool of nodes
+                        link: the link of the node being added
+Result:                 True if the node was added, LF_BUSY if another thread
+                        changed the list first
+----------------------------------------------------------------------------*/
+static long try_give_node (_Atomic unsigned long * list, LFNode * nodes, 
+                           unsigned long link) 
+{
+    unsigned long old = 0;      /* tagged link before the change */
+    unsigned long new = 0;      /* tagged link after the change */
+
+    old = atomic_load_explicit (list, memory_order_relaxed);
+    atomic_store_explicit (&nodes[link - 1].next, old & LINK_MASK,
+                           memory_order_relaxed);
+    new = link | ( (old & ~LINK_MASK) + TAG_ONE );
+
+    /* If statement is executed if another thread changed the list first */
+    if ( !atomic_compare_exchange_strong_explicit (list, &old, new,
+                memory_order_release, memory_order_relaxed) )
+    {
+        return LF_BUSY;
+    }
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          try_take_node
+Purpose:                This function makes a single attempt to unlink the
+                        first node of a list
+Description:            This function works like take_node but gives up
+                        instead of retrying when the compare-and-swap fails
+Input:                  list: the tagged link of the list
+                        nodes: the pool of nodes
+                        link: the link of the node removed
+Result:                 True if a node was removed, false if the list is
+                        empty, LF_BUSY if another thread changed the list
+                        first
+----------------------------------------------------------------------------*/
+static long try_take_node (_Atomic unsigned long * list, LFNode * nodes,
+                           unsigned long * link) 
+{
+    unsigned long old = 0;      /* tagged link before the change */
+    unsigned long new = 0;      /* tagged link after the change */
+    unsigned long next = 0;     /* link of the node below the first */
+
+    old = atomic_load_explicit (list, memory_order_acquire);
+
+    /* If statement is executed when the list is empty */
+    if ( !(old & LINK_MASK) )
+    {
+        return 0;
+    }
+
+    next = atomic_load_explicit (&nodes[(old & LINK_MASK) - 1].next,
+                                 memory_order_relaxed);
+    new = next | ( (old & ~LINK_MASK) + TAG_ONE );
+
+    /* If statement is executed if another thread changed the list first */
+    if ( !atomic_compare_exchange_strong_explicit (list, &old, new,
+                memory_order_acquire, memory_order_relaxed) )
+    {
+        return LF_BUSY;
+    }
+
+    *link = old & LINK_MASK;
+
+    return 1;
+}
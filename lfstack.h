@@ -0,0 +1,47 @@
+#ifndef LFSTACK_H
+#define LFSTACK_H
+
+/* This lock-free implementation of stack is a Treiber stack of longs that
+may be shared by any number of pushing and popping threads.  Elements are
+kept in nodes taken from a pool allocated once in new_LFStack, so pushing
+and popping never call malloc.  The top of the stack and the pool's free
+list are tagged node indices, and every change bumps the tag so that a node
+which is popped and pushed again between another thread's read and its
+compare-and-swap cannot be mistaken for the old top (the ABA problem). */
+
+#define LF_BUSY (-2)    /* result of a single attempt that lost a race */
+
+typedef struct LFStack LFStack;
+
+void delete_LFStack (LFStack **); /* deallocates memory allocated in
+                                   new_LFStack.  No other thread may be
+                                   using the stack.  Assigns incoming
+                                   pointer to NULL. */
+long isempty_LFStack (LFStack *); /* returns 0 or non-0 value indicating
+                                   whether or not the stack is empty */
+long isfull_LFStack (LFStack *); /* returns 0 or non-0 value indicating
+                                   whether or not the stack is full */
+LFStack * new_LFStack (unsigned long); /* allocates the stack and its pool of
+                                   nodes.  Result is the new stack, or NULL
+                                   if memory could not be allocated */
+long pop_LFStack (LFStack *, long *); /* removes and sends back the top
+                                   element of the stack.  Result is 0 or
+                                   non-0, indicating failure or success,
+                                   respectively */
+long push_LFStack (LFStack *, long); /* places one value on the stack.
+                                   Result is 0 or non-0 indicating failure
+                                   or success, respectively */
+long top_LFStack (LFStack *, long *); /* sends back the top element of the
+                                   stack.  Stack is left unaffected.  Result
+                                   is 0 or non-0 indicating failure or
+                                   success, respectively. */
+long trypop_LFStack (LFStack *, long *); /* makes one attempt at pop_LFStack.
+                                   Result is as for pop_LFStack, or LF_BUSY
+                                   if another thread changed the stack
+                                   first */
+long trypush_LFStack (LFStack *, long); /* makes one attempt at
+                                   push_LFStack.  Result is as for
+                                   push_LFStack, or LF_BUSY if another
+                                   thread changed the stack first */
+
+#endif
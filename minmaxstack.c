@@ -0,0 +1,390 @@
+/******************************************************************************
+
+File Name:      minmaxstack.c
+Description:    This program implements a stack of longs that reports its
+                smallest and largest element in constant time.  The values
+                are kept in a Stack from stack.c, and the minimums and
+                maximums each in a growable Stack that only holds the values
+                that changed them.
+
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "minmaxstack.h"
+#include "mylib.h"
+
+#define MINMAX_EXTREMA 8        /* longs first kept for each of the minimums
+                                   and maximums */
+
+/* catastrophic error messages */
+static const char ALLOCATE_FAILED[] =
+                        "Allocating a min/max stack failed!!!\n";
+static const char DELETE_NONEXIST[] = "Deleting a non-existent stack!!!\n";
+static const char EXTREME_EMPTY[] =
+                        "Asking an empty stack for an extreme!!!\n";
+static const char EXTREME_NONEXIST[] =
+                        "Asking a non-existent stack for an extreme!!!\n";
+static const char INCOMING_NONEXIST[] =
+                        "Incoming parameter does not exist!!!\n";
+
+/* The three stacks.  The tops of minimums and maximums are the extremes of
+ * the values, and both are empty exactly when values is. */
+struct MinMaxStack
+{
+    Stack * values;         /* the elements */
+    Stack * minimums;       /* each value that was a new minimum */
+    Stack * maximums;       /* each value that was a new maximum */
+};
+
+static long make_room (Stack ** spp);
+
+
+/*----------------------------------------------------------------------------
+Function Name:          delete_MinMaxStack
+Purpose:                This function deletes a created min/max stack
+Description:            This function checks to see if the stack exists. If
+                        not, an error message is printed. If so, its three
+                        stacks and the stack itself are deallocated and the
+                        caller's pointer is set to NULL
+Input:                  spp: the stack from which we will deallocate memory
+Result:                 Deletes the created stack or prints an error message
+----------------------------------------------------------------------------*/
+void delete_MinMaxStack (MinMaxStack ** spp)
+{
+    /* If statement is executed if spp or the stack it points to does not
+     * exist */
+    if (!spp || !*spp)
+    {
+        writeline (DELETE_NONEXIST, stderr);   /* error message printed */
+        return;
+    }
+
+    delete_Stack (&(*spp)->values);
+    delete_Stack (&(*spp)->minimums);
+    delete_Stack (&(*spp)->maximums);
+    free (*spp);
+    *spp = NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          empty_MinMaxStack
+Purpose:                This function empties a min/max stack
+Description:            This function empties the values along with the
+                        minimums and maximums, each with empty_Stack
+Input:                  this_Stack: the stack which will be emptied
+Result:                 Empties the items in the stack or prints an error
+                        message
+----------------------------------------------------------------------------*/
+void empty_MinMaxStack (MinMaxStack * this_Stack)
+{
+    empty_Stack (this_Stack ? this_Stack->values : NULL);
+
+    /* If statement is executed if the stack exists */
+    if (this_Stack)
+    {
+        empty_Stack (this_Stack->minimums);
+        empty_Stack (this_Stack->maximums);
+    }
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          get_max_MinMaxStack
+Purpose:                This function sends back the largest element
+Description:            This function reads the top of the maximums, which is
+                        the largest of the values on the stack
+Input:                  this_Stack: the stack in question
+                        item: the largest element
+Result:                 True if the stack has elements. False if the stack or
+                        item does not exist or the stack is empty and an
+                        error message is printed
+----------------------------------------------------------------------------*/
+long get_max_MinMaxStack (MinMaxStack * this_Stack, long * item)
+{
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (EXTREME_NONEXIST, stderr);   /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the item is not yet set */
+    if (!item)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the stack is empty */
+    if (this_Stack->maximums[STACK_POINTER_INDEX] < 0)
+    {
+        writeline (EXTREME_EMPTY, stderr);      /* error message printed */
+        return 0;
+    }
+
+    *item = this_Stack->maximums[this_Stack->maximums[STACK_POINTER_INDEX]];
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          get_min_MinMaxStack
+Purpose:                This function sends back the smallest element
+Description:            This function reads the top of the minimums, which is
+                        the smallest of the values on the stack
+Input:                  this_Stack: the stack in question
+                        item: the smallest element
+Result:                 True if the stack has elements. False if the stack or
+                        item does not exist or the stack is empty and an
+                        error message is printed
+----------------------------------------------------------------------------*/
+long get_min_MinMaxStack (MinMaxStack * this_Stack, long * item)
+{
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (EXTREME_NONEXIST, stderr);   /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the item is not yet set */
+    if (!item)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the stack is empty */
+    if (this_Stack->minimums[STACK_POINTER_INDEX] < 0)
+    {
+        writeline (EXTREME_EMPTY, stderr);      /* error message printed */
+        return 0;
+    }
+
+    *item = this_Stack->minimums[this_Stack->minimums[STACK_POINTER_INDEX]];
+
+    return 1;
+}
+
+
+/* whether the stack is empty, as isempty_Stack reports it */
+long isempty_MinMaxStack (MinMaxStack * this_Stack)
+{
+    return isempty_Stack (this_Stack ? this_Stack->values : NULL);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          new_MinMaxStack
+Purpose:                This function allocates a min/max stack able to hold
+                        stacksize longs
+Description:            This function allocates the stack of values at its
+                        full size and the minimums and maximums at
+                        MINMAX_EXTREMA longs, since they only grow as far as
+                        the extremes change
+Input:                  stacksize: number of longs the stack can hold
+Result:                 A pointer to the new stack, or NULL if memory could
+                        not be allocated and an error message is printed
+----------------------------------------------------------------------------*/
+MinMaxStack * new_MinMaxStack (unsigned long stacksize)
+{
+    MinMaxStack * this_Stack = malloc (sizeof(MinMaxStack)); /* new stack */
+
+    /* If statement is executed if the stack could not be allocated */
+    if (!this_Stack)
+    {
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    this_Stack->values = new_Stack (stacksize);
+    this_Stack->minimums = new_Stack (MINMAX_EXTREMA);
+    this_Stack->maximums = new_Stack (MINMAX_EXTREMA);
+
+    /* If statement is executed if any of the stacks was not allocated */
+    if (!this_Stack->values || !this_Stack->minimums ||
+        !this_Stack->maximums)
+    {
+        /* If statement is executed if the values were allocated */
+        if (this_Stack->values)
+        {
+            delete_Stack (&this_Stack->values);
+        }
+
+        /* If statement is executed if the minimums were allocated */
+        if (this_Stack->minimums)
+        {
+            delete_Stack (&this_Stack->minimums);
+        }
+
+        /* If statement is executed if the maximums were allocated */
+        if (this_Stack->maximums)
+        {
+            delete_Stack (&this_Stack->maximums);
+        }
+        free (this_Stack);
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    return this_Stack;
+}
+
+
+/* the number of elements, as num_elements reports it */
+long num_elements_MinMaxStack (MinMaxStack * this_Stack)
+{
+    return num_elements (this_Stack ? this_Stack->values : NULL);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          pop_MinMaxStack
+Purpose:                This function removes the top item in stack
+Description:            This function pops the values with pop. A popped
+                        value equal to the top of the minimums or maximums
+                        is the extreme it recorded there, so it is removed
+                        from there too
+Input:                  this_Stack: the stack from which we are getting our
+                                    items
+                        item: the number we will remove from the stack
+Result:                 The result of pop, which prints the error messages
+----------------------------------------------------------------------------*/
+long pop_MinMaxStack (MinMaxStack * this_Stack, long * item)
+{
+    Stack * extremes = 0;   /* the minimums or maximums */
+
+    /* If statement is executed if the stack is empty or does not exist */
+    if ( !pop (this_Stack ? this_Stack->values : NULL, item) )
+    {
+        return 0;
+    }
+
+    extremes = this_Stack->minimums;
+
+    /* If statement is executed if the item was the smallest element */
+    if (extremes[extremes[STACK_POINTER_INDEX]] == *item)
+    {
+        extremes[STACK_POINTER_INDEX]--;
+    }
+
+    extremes = this_Stack->maximums;
+
+    /* If statement is executed if the item was the largest element */
+    if (extremes[extremes[STACK_POINTER_INDEX]] == *item)
+    {
+        extremes[STACK_POINTER_INDEX]--;
+    }
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          push_MinMaxStack
+Purpose:                This function adds a new element to the top of stack
+Description:            This function works out whether the item is a new
+                        minimum or maximum, or equals the current one, and
+                        makes room for it on those stacks first, so that a
+                        failure leaves the whole stack unaffected. The item
+                        is then pushed with push and recorded as an extreme
+                        where it is one
+Input:                  this_Stack: the stack in question
+                        item: the long being stored to the top of stack
+Result:                 The result of push, which prints the error messages,
+                        or 0 if room for an extreme could not be made and an
+                        error message is printed
+----------------------------------------------------------------------------*/
+long push_MinMaxStack (MinMaxStack * this_Stack, long item)
+{
+    Stack * extremes = 0;   /* the minimums or maximums */
+    long minimum = 0;       /* whether item is a minimum */
+    long maximum = 0;       /* whether item is a maximum */
+    long status = 0;        /* result of push */
+
+    /* If statement is executed if the stack does not exist or EOF is
+     * reached, which push reports */
+    if (!this_Stack || item == EOF)
+    {
+        return push (this_Stack ? this_Stack->values : NULL, item);
+    }
+
+    extremes = this_Stack->minimums;
+    minimum = extremes[STACK_POINTER_INDEX] < 0 ||
+              item <= extremes[extremes[STACK_POINTER_INDEX]];
+    extremes = this_Stack->maximums;
+    maximum = extremes[STACK_POINTER_INDEX] < 0 ||
+              item >= extremes[extremes[STACK_POINTER_INDEX]];
+
+    /* If statement is executed if an extreme cannot be recorded */
+    if ( (minimum && !make_room (&this_Stack->minimums)) ||
+         (maximum && !make_room (&this_Stack->maximums)) )
+    {
+        return 0;
+    }
+
+    status = push (this_Stack->values, item);
+
+    /* If statement is executed if the item was pushed */
+    if (status == 1)
+    {
+        /* If statement is executed if the item is a new minimum */
+        if (minimum)
+        {
+            extremes = this_Stack->minimums;
+            extremes[++extremes[STACK_POINTER_INDEX]] = item;
+        }
+
+        /* If statement is executed if the item is a new maximum */
+        if (maximum)
+        {
+            extremes = this_Stack->maximums;
+            extremes[++extremes[STACK_POINTER_INDEX]] = item;
+        }
+    }
+
+    return status;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          top_MinMaxStack
+Purpose:                This function sends back the top element in the stack
+Description:            This function tops the values with top
+Input:                  this_Stack: the stack from which we are getting our
+                                    items
+                        item: the number on top of the stack
+Result:                 The result of top, which prints the error messages
+----------------------------------------------------------------------------*/
+long top_MinMaxStack (MinMaxStack * this_Stack, long * item)
+{
+    return top (this_Stack ? this_Stack->values : NULL, item);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          make_room
+Purpose:                This function makes room for one more extreme
+Description:            This function grows a full stack of extremes to
+                        twice its size with reserve_Stack. The extremes are
+                        written directly rather than pushed, so that they
+                        are not traced or counted as stack operations
+Input:                  spp: the minimums or maximums
+Result:                 True if there is room. False if the stack could not
+                        be grown and an error message is printed
+----------------------------------------------------------------------------*/
+static long make_room (Stack ** spp)
+{
+    long size = (*spp)[STACK_SIZE_INDEX];   /* size of the stack */
+
+    /* If statement is executed if the stack still has room */
+    if ( (*spp)[STACK_POINTER_INDEX] + 1 < size )
+    {
+        return 1;
+    }
+
+    return reserve_Stack (spp, size ? size * 2 : 1);
+}
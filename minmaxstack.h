@@ -0,0 +1,52 @@
+#ifndef MINMAXSTACK_H
+#define MINMAXSTACK_H
+
+#include "stack.h"
+
+/* A min/max stack is a stack of longs that also knows its smallest and
+largest element at all times.  Next to the stack of values it keeps a
+stack of minimums and a stack of maximums, and a value is pushed on one of
+those only when it is a new minimum or maximum, or equals the current one.
+Popping a value that is on top of either stack of extremes pops it there
+too, so the extremes of what is left are on top again.  Every operation
+takes constant time, and values that do not change the extremes take no
+extra memory.  The functions mirror push, pop and top in stack.h. */
+
+typedef struct MinMaxStack MinMaxStack;
+
+void delete_MinMaxStack (MinMaxStack **); /* deallocates memory allocated
+                                   in new_MinMaxStack.  Assigns incoming
+                                   pointer to NULL. */
+void empty_MinMaxStack (MinMaxStack *); /* empties the stack in constant
+                                   time */
+long get_max_MinMaxStack (MinMaxStack *, long *); /* sends back the largest
+                                   element of the stack.  Result is 0 or
+                                   non-0 indicating failure or success,
+                                   respectively */
+long get_min_MinMaxStack (MinMaxStack *, long *); /* sends back the smallest
+                                   element of the stack.  Result is 0 or
+                                   non-0 indicating failure or success,
+                                   respectively */
+long isempty_MinMaxStack (MinMaxStack *); /* returns 0 or non-0 value
+                                   indicating whether or not the stack is
+                                   empty */
+MinMaxStack * new_MinMaxStack (unsigned long); /* allocates a stack able to
+                                   hold the given number of longs.  Result
+                                   is the new stack, or NULL if memory
+                                   could not be allocated */
+long num_elements_MinMaxStack (MinMaxStack *); /* returns the number of
+                                   elements stored on the stack */
+long pop_MinMaxStack (MinMaxStack *, long *); /* removes and sends back the
+                                   top element of the stack.  Result is 0
+                                   or non-0, indicating failure or success,
+                                   respectively */
+long push_MinMaxStack (MinMaxStack *, long); /* places one value on the
+                                   stack.  Result is 0 or non-0 indicating
+                                   failure or success, respectively, and
+                                   EOF as for push */
+long top_MinMaxStack (MinMaxStack *, long *); /* sends back the top element
+                                   of the stack.  Stack is left unaffected.
+                                   Result is 0 or non-0 indicating failure
+                                   or success, respectively. */
+
+#endif
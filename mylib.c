@@ -1,5 +1,7 @@
 #include <ctype.h>
+#include <limits.h>
 #include <stdio.h>
+#include <string.h>
 #include "mylib.h"
 
 #define ASCII_ZERO 0x30
@@ -7,13 +9,18 @@
 
 static char hexdigits[] = "0123456789ABCDEF";
 
-static void posdecout (unsigned long number);
+/* every pair of decimal digits, so numbers are converted two digits at a
+ * time */
+static const char digitpairs[] = 
+        "00010203040506070809101112131415161718192021222324252627282930313233"
+        "34353637383940414243444546474849505152535455565758596061626364656667"
+        "6869707172737475767778798081828384858687888990919293949596979899";
 
 void clrbuf (int character) {
 
         /* check for buffer already being empty */
         /* then remove all characters from buffer until empty */
-        while (character != '\n')
+        while (character != '\n' && character != EOF)
                 character = getchar ();
 }
 
@@ -41,63 +48,122 @@ long decin (void) {
 }
 
 void decout (long number) {
-        if (number < 0) {
-                putchar ('-');
-                posdecout (- number);
-        }
-        else
-                posdecout (number);
+        char buffer[DECOUT_SIZE];       /* the number in ASCII */
+
+        /* convert the whole number, then output it at once */
+        sdecout (number, buffer);
+        writeline (buffer, stdout);
 }
 
 void hexout (unsigned long number) {
-        unsigned long count = 0;        /* counter for loop */
-        unsigned long digit;            /* individual digit for output */
+        char buffer[HEXOUT_SIZE];       /* the number in ASCII */
 
-        /* output "0x" for hexidecimal */
-        writeline ("0x", stdout);
+        /* convert the whole number, then output it at once */
+        shexout (number, buffer);
+        writeline (buffer, stdout);
+}
 
-        for (; count < COUNT; count++) {
+void newline (void) {
+        putchar ('\n');
+}
 
-                /* get digit to print */
-                digit = number >> ((COUNT - 1) << 2);
+long sdecin (const char * buffer, long * number) {
+        const char * start = buffer;    /* where the number begins */
+        unsigned long limit = LONG_MAX; /* largest magnitude allowed */
+        unsigned long sum = 0;          /* accumulated magnitude */
+        unsigned long digit;            /* each digit as it is found */
+        int negative = FALSE;           /* whether a minus sign was found */
+
+        /* optional sign, a negative number may reach one past LONG_MAX */
+        if (*buffer == '-' || *buffer == '+') {
+                negative = *buffer++ == '-';
+                if (negative)
+                        limit = (unsigned long) LONG_MAX + 1;
+        }
+
+        /* a number needs at least one digit */
+        if (!isdigit ((unsigned char) *buffer))
+                return 0;
 
-                /* output digit in ASCII*/
-                putchar (hexdigits[digit]);
+        /* input terminates with a non-digit character */
+        while (isdigit ((unsigned char) *buffer)) {
 
-                /* set up for next digit */
-                number <<= 4;
+                /* change from ASCII */
+                digit = *buffer++ & ~ASCII_ZERO;
+
+                /* accumulate number, failing before it overflows */
+                if (sum > (limit - digit) / 10)
+                        return 0;
+                sum = sum * 10 + digit;
         }
-}
 
-void newline (void) {
-        putchar ('\n');
+        /* result found */
+        *number = negative ? (long) (0 - sum) : (long) sum;
+        return buffer - start;
 }
 
-long writeline (const char * string, FILE * stream) {
-        long index = 0;         /* generic loop index */
+long sdecout (long number, char * buffer) {
+        char digits[DECOUT_SIZE];       /* digits, filled from the right */
+        long index = DECOUT_SIZE;       /* leftmost digit filled so far */
+        long length = 0;                /* characters output */
+        unsigned long pair;             /* offset of two digits in table */
+        unsigned long rest;             /* magnitude still to convert */
+
+        /* convert the magnitude, taking care with the most negative long */
+        rest = number < 0 ? 0 - (unsigned long) number : (unsigned long) number;
+
+        /* output two digits at a time from the right */
+        while (rest >= 100) {
+                pair = (rest % 100) << 1;
+                rest /= 100;
+                digits[--index] = digitpairs[pair + 1];
+                digits[--index] = digitpairs[pair];
+        }
 
-        /* output string character by character */
-        while (string[index])
-                fputc(string[index++], stream);
+        /* one or two digits are left */
+        if (rest >= 10) {
+                pair = rest << 1;
+                digits[--index] = digitpairs[pair + 1];
+                digits[--index] = digitpairs[pair];
+        }
+        else
+                digits[--index] = hexdigits[rest];
 
-        /* return the length of string */
-        return index;
+        /* sign, then the digits */
+        if (number < 0)
+                buffer[length++] = '-';
+        memcpy (buffer + length, digits + index, DECOUT_SIZE - index);
+        length += DECOUT_SIZE - index;
+        buffer[length] = '\0';
+
+        /* return the length of the number */
+        return length;
 }
 
-static void posdecout (unsigned long number) {
-        unsigned long quotient;         /* quotient of div by 10 */
-        long remainder;         /* remainder of div by 10 */
+long shexout (unsigned long number, char * buffer) {
+        long count = COUNT;             /* digits left to output */
 
-        /* remove one digit from number
-                digit (remainder) is for output, 
-                the rest of the number (quotient) still needs to be printed */
-        remainder = number % 10;
-        quotient = number / 10;
+        /* output "0x" for hexidecimal */
+        buffer[0] = '0';
+        buffer[1] = 'x';
+        buffer[COUNT + 2] = '\0';
+
+        /* output digits in ASCII from the right */
+        while (count) {
+                buffer[1 + count--] = hexdigits[number & 0xF];
+                number >>= 4;
+        }
 
-        /* call function to output remaining digits, if any */
-        if (quotient)
-                posdecout (quotient);
+        /* return the length of the number */
+        return COUNT + 2;
+}
 
-        /* output digit */
-        putchar (hexdigits [remainder]);
+long writeline (const char * string, FILE * stream) {
+        size_t length = strlen (string);        /* length of string */
+
+        /* output string all at once */
+        fwrite (string, 1, length, stream);
+
+        /* return the length of string */
+        return length;
 }
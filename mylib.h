@@ -6,8 +6,15 @@ long decin (void);
 void decout (long number);
 void hexout (unsigned long);
 void newline (void);
+long sdecin (const char *, long *);
+long sdecout (long, char *);
+long shexout (unsigned long, char *);
 long writeline (const char *, FILE *);
 
+/* buffer sizes for sdecout and shexout, terminating '\0' included */
+#define DECOUT_SIZE 21
+#define HEXOUT_SIZE ((long) (sizeof (long) << 1) + 3)
+
 #ifndef TRUE
 #define TRUE 1
 #endif
@@ -0,0 +1,304 @@
+/******************************************************************************
+
+File Name:      pstack.c
+Description:    This program implements stacks of longs that are kept in a
+                file.  The file is mapped into memory with the stack header
+                and user data at the same offsets a heap stack uses, so the
+                stack is pushed and popped with the functions in stack.c,
+                and reopening the file makes the stack available again
+                without reading or replaying its contents.
+
+******************************************************************************/
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "mylib.h"
+#include "pstack.h"
+
+#define PSTACK_MAGIC 0x314B545350435453L    /* "STCPSTK1" in the file */
+#define PSTACK_VERSION 5        /* version of the file layout */
+#define PSTACK_MAGIC_INDEX 0    /* Index of magic number in the file */
+#define PSTACK_VERSION_INDEX 1  /* Index of file layout version */
+#define PSTACK_WIDTH_INDEX 2    /* Index of bytes in a long */
+#define PSTACK_OFFSET_INDEX 3   /* Index of longs in the stack header */
+#define PSTACK_HEADER 4         /* longs in the file header */
+
+/* longs in the file of a stack holding stacksize longs */
+#define PSTACK_LONGS(stacksize) \
+    ( (stacksize) + PSTACK_HEADER + STACK_OFFSET )
+
+/* start of the mapping behind a stack */
+#define PSTACK_BASE(this_Stack) \
+    ( (this_Stack) - STACK_OFFSET - PSTACK_HEADER )
+
+/* catastrophic error messages */
+static const char CLOSE_NONEXIST[] = "Closing a non-existent stack!!!\n";
+static const char CLOSE_UNMAPPED[] = 
+                        "Closing a stack not opened from a file!!!\n";
+static const char OPEN_CORRUPT[] = "Opening a corrupt stack file!!!\n";
+static const char OPEN_FAILED[] = "Opening a stack file failed!!!\n";
+static const char OPEN_RESTORE[] = 
+                        "Restoring the length of a stack file failed!!!\n";
+static const char SYNC_FAILED[] = "Syncing a stack file failed!!!\n";
+static const char SYNC_NONEXIST[] = "Syncing a non-existent stack!!!\n";
+
+static Stack * map_file (int fd, unsigned long longs, off_t length);
+
+
+/*----------------------------------------------------------------------------
+Function Name:          close_PStack
+Purpose:                This function closes a stack opened from a file
+Description:            This function checks that the stack exists and is
+                        file-backed, frees what is kept beside it with
+                        detach_Stack, then unmaps the whole file and sets
+                        the caller's pointer to NULL. Unsynced changes are left
+                        for the system to write back
+Input:                  spp: the stack being closed
+Result:                 The stack is unmapped or an error message is printed
+----------------------------------------------------------------------------*/
+void close_PStack (Stack ** spp) 
+{
+    /* If statement is executed if spp or the stack it points to does not
+     * exist */
+    if (!spp || !*spp)
+    {
+        writeline (CLOSE_NONEXIST, stderr);    /* error message printed */
+        return;
+    }
+
+    /* If statement is executed if the stack does not live in a file */
+    if ( (*spp)[STACK_BLOCK_INDEX] != STACK_MAPPED )
+    {
+        writeline (CLOSE_UNMAPPED, stderr);    /* error message printed */
+        return;
+    }
+
+    detach_Stack (*spp);
+    munmap ( PSTACK_BASE (*spp), 
+             PSTACK_LONGS ((*spp)[STACK_SIZE_INDEX]) * sizeof(long) );
+    *spp = NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          open_PStack
+Purpose:                This function opens a stack kept in a file
+Description:            This function opens or creates the file. An empty file
+                        is sized for stacksize longs and given a file header
+                        and an empty stack. An existing file is mapped and
+                        checked: its magic number, version, width of a long
+                        and stack header length must match, its length must
+                        match the size in its header, and its stack pointer
+                        must lie inside the stack. A file holding fewer than
+                        stacksize longs is then lengthened and mapped again.
+                        Nothing but the headers is read, so opening takes
+                        the same time for any size of stack. The stack is
+                        given a new number each time it is opened, so marks
+                        taken before it was last closed are refused
+Input:                  filename: the file holding the stack
+                        stacksize: number of longs the stack must hold
+Result:                 A pointer to where user data begins, or NULL if the
+                        file cannot be opened, mapped or grown, or is corrupt,
+                        and an error message is printed
+----------------------------------------------------------------------------*/
+Stack * open_PStack (const char * filename, unsigned long stacksize) 
+{
+    Stack * this_Stack = 0;     /* the mapped stack */
+    Stack * base = 0;           /* start of the mapping */
+    struct stat status;         /* length of the file */
+    long size = 0;              /* size of an existing stack */
+    int fd = -1;                /* the open file */
+
+    /* If statement is executed if the size overflows the file length */
+    if (stacksize > (unsigned long)-1 / sizeof(long) - PSTACK_LONGS (0))
+    {
+        writeline (OPEN_FAILED, stderr);       /* error message printed */
+        return NULL;
+    }
+
+    fd = open (filename, O_RDWR | O_CREAT, 0644);
+
+    /* If statement is executed if the file cannot be opened */
+    if (fd < 0 || fstat (fd, &status) < 0)
+    {
+        if (fd >= 0)
+        {
+            close (fd);
+        }
+        writeline (OPEN_FAILED, stderr);       /* error message printed */
+        return NULL;
+    }
+
+    /* If statement is executed if the file is new, the stack is created */
+    if (status.st_size == 0)
+    {
+        this_Stack = map_file (fd, PSTACK_LONGS (stacksize), 0);
+        close (fd);
+
+        if (!this_Stack)
+        {
+            return NULL;
+        }
+
+        base = PSTACK_BASE (this_Stack);
+        base[PSTACK_MAGIC_INDEX] = PSTACK_MAGIC;
+        base[PSTACK_VERSION_INDEX] = PSTACK_VERSION;
+        base[PSTACK_WIDTH_INDEX] = sizeof(long);
+        base[PSTACK_OFFSET_INDEX] = STACK_OFFSET;
+        this_Stack[STACK_BLOCK_INDEX] = STACK_MAPPED;
+        this_Stack[STACK_LOW_INDEX] = 0;
+        this_Stack[STACK_MARKS_INDEX] = 0;
+        this_Stack[STACK_STATS_INDEX] = 0;
+        this_Stack[STACK_SIZE_INDEX] = stacksize;
+        this_Stack[STACK_POINTER_INDEX] = -1;
+        renumber_Stack (this_Stack);
+
+        return this_Stack;
+    }
+
+    /* If statement is executed if the file is too short for the headers */
+    if ( (unsigned long)status.st_size < PSTACK_LONGS (0) * sizeof(long) )
+    {
+        close (fd);
+        writeline (OPEN_CORRUPT, stderr);      /* error message printed */
+        return NULL;
+    }
+
+    this_Stack = map_file (fd, status.st_size / sizeof(long), status.st_size);
+
+    if (!this_Stack)
+    {
+        close (fd);
+        return NULL;
+    }
+
+    base = PSTACK_BASE (this_Stack);
+    size = this_Stack[STACK_SIZE_INDEX];
+
+    /* If statement is executed if the headers do not describe this file */
+    if ( base[PSTACK_MAGIC_INDEX] != PSTACK_MAGIC ||
+         base[PSTACK_VERSION_INDEX] != PSTACK_VERSION ||
+         base[PSTACK_WIDTH_INDEX] != sizeof(long) ||
+         base[PSTACK_OFFSET_INDEX] != STACK_OFFSET ||
+         this_Stack[STACK_BLOCK_INDEX] != STACK_MAPPED ||
+         size < 0 ||
+         (unsigned long)status.st_size != PSTACK_LONGS (size) * sizeof(long) ||
+         this_Stack[STACK_POINTER_INDEX] < -1 ||
+         this_Stack[STACK_POINTER_INDEX] >= size )
+    {
+        munmap (base, status.st_size);
+        close (fd);
+        writeline (OPEN_CORRUPT, stderr);      /* error message printed */
+        return NULL;
+    }
+
+    /* If statement is executed if the stack must be grown to stacksize */
+    if ( (unsigned long)size < stacksize )
+    {
+        munmap (base, status.st_size);
+        this_Stack = map_file (fd, PSTACK_LONGS (stacksize), status.st_size);
+
+        if (this_Stack)
+        {
+            this_Stack[STACK_SIZE_INDEX] = stacksize;
+        }
+    }
+
+    close (fd);
+
+    /* If statement is executed if the stack was mapped, when it is given a
+     * number of its own as a stack in memory would be, and forgets the
+     * marks and counters of the process that last had it open */
+    if (this_Stack)
+    {
+        renumber_Stack (this_Stack);
+        this_Stack[STACK_MARKS_INDEX] = 0;
+        this_Stack[STACK_STATS_INDEX] = 0;
+    }
+
+    return this_Stack;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          sync_PStack
+Purpose:                This function checkpoints a stack kept in a file
+Description:            This function writes every changed page of the
+                        mapping back to the file and waits until the writes
+                        are complete
+Input:                  this_Stack: the stack being synced
+Result:                 True if the stack reached the file. False if the
+                        stack does not exist, is not file-backed or could
+                        not be written and an error message is printed
+----------------------------------------------------------------------------*/
+long sync_PStack (Stack * this_Stack) 
+{
+    /* If statement is executed if the stack is not a file-backed stack */
+    if (!this_Stack || this_Stack[STACK_BLOCK_INDEX] != STACK_MAPPED)
+    {
+        writeline (SYNC_NONEXIST, stderr);     /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the pages could not be written */
+    if ( msync (PSTACK_BASE (this_Stack), 
+                PSTACK_LONGS (this_Stack[STACK_SIZE_INDEX]) * sizeof(long),
+                MS_SYNC) < 0 )
+    {
+        writeline (SYNC_FAILED, stderr);       /* error message printed */
+        return 0;
+    }
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          map_file
+Purpose:                This function maps a stack file into memory
+Description:            This function sets the length of the file, which
+                        leaves any new part reading as zeroes without
+                        writing it, then maps the whole file shared so that
+                        stores to the stack go to the file. If the file
+                        cannot be mapped it is cut back to the length it
+                        had, so that a file being created is left empty and
+                        a file being grown still matches its header
+Input:                  fd: the open file
+                        longs: length of the file in longs
+                        length: length of the file in bytes before this
+Result:                 A pointer to where user data begins in the mapping,
+                        or NULL if the file could not be sized or mapped and
+                        an error message is printed
+----------------------------------------------------------------------------*/
+static Stack * map_file (int fd, unsigned long longs, off_t length) 
+{
+    void * memory = MAP_FAILED;     /* the mapping */
+
+    /* If statement is executed if the file was sized, when it is mapped
+     * or, failing that, cut back */
+    if (ftruncate (fd, longs * sizeof(long)) == 0)
+    {
+        memory = mmap (NULL, longs * sizeof(long), PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+
+        /* If statement is executed if the file could not be mapped */
+        if ( memory == MAP_FAILED &&
+             (off_t)(longs * sizeof(long)) != length &&
+             ftruncate (fd, length) != 0 )
+        {
+            writeline (OPEN_RESTORE, stderr);  /* error message printed */
+        }
+    }
+
+    /* If statement is executed if the file could not be sized or mapped */
+    if (memory == MAP_FAILED)
+    {
+        writeline (OPEN_FAILED, stderr);       /* error message printed */
+        return NULL;
+    }
+
+    return (Stack *)memory + PSTACK_HEADER + STACK_OFFSET;
+}
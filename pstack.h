@@ -0,0 +1,31 @@
+#ifndef PSTACK_H
+#define PSTACK_H
+
+#include "stack.h"
+
+/* A persistent stack is a Stack whose header and user data are mapped from
+a file instead of allocated from the heap, so it survives the program and
+is reopened by mapping the file again rather than by pushing every element
+again.  Once open it is used with the functions of stack.h, except that it
+cannot be deleted with delete_Stack or resized.  The file holds a short
+file header followed by the stack header slots and the user data, exactly
+as they sit in memory.  Changes reach the file as the system writes back
+the mapped pages; sync_PStack forces them out for a checkpoint. */
+
+void close_PStack (Stack **);   /* unmaps a stack opened by open_PStack.
+                                   Changes not yet synced are still written
+                                   back by the system.  Assigns incoming
+                                   pointer to NULL. */
+Stack * open_PStack (const char *, unsigned long); /* maps the stack in
+                                   the named file, creating the file with
+                                   room for the given number of longs if it
+                                   is empty or missing, and growing it if it
+                                   holds fewer.  Result is a pointer in the
+                                   array where user data allotment begins,
+                                   or NULL on failure */
+long sync_PStack (Stack *);     /* writes the stack back to its file and
+                                   waits for it to reach the disk.  Result
+                                   is 0 or non-0 indicating failure or
+                                   success, respectively */
+
+#endif
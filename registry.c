@@ -0,0 +1,307 @@
+/******************************************************************************
+
+File Name:      registry.c
+Description:    This program implements the stack registry, which hands out
+                integer handles for stacks.  Entries are kept in pages that
+                are allocated as the registry fills and never moved, so a
+                handle is turned back into its stack in constant time and
+                without a lock, while a mutex orders the adding and removing
+                of stacks.  A generation in every handle catches handles
+                used after their stack was removed.
+
+******************************************************************************/
+
+#include <limits.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "mylib.h"
+#include "registry.h"
+
+#define REGISTRY_PAGE_BITS 10   /* bits of an index choosing the entry */
+#define REGISTRY_PAGE (1L << REGISTRY_PAGE_BITS) /* entries in a page */
+#define REGISTRY_PAGES 1024     /* most pages in the registry */
+#define REGISTRY_INDEX_BITS 20  /* bits of a handle holding the index */
+#define REGISTRY_INDEX_MASK ((1L << REGISTRY_INDEX_BITS) - 1)
+#define REGISTRY_GENERATIONS (LONG_MAX >> REGISTRY_INDEX_BITS) /* most
+                                   generations before they start over */
+
+/* catastrophic error messages */
+static const char ADD_FAILED[] = "Registering a stack failed!!!\n";
+static const char ADD_NONEXIST[] = "Registering a non-existent stack!!!\n";
+static const char HANDLE_UNKNOWN[] = "Using an unknown stack handle!!!\n";
+
+/* One entry of the registry.  The stack and generation are atomic since
+ * they are read without the mutex; next is only used under it. */
+typedef struct RegistryEntry
+{
+    _Atomic long generation;    /* generation handles must match */
+    _Atomic (Stack *) stack;    /* the stack, NULL when the entry is free */
+    long next;                  /* next free entry, or -1 */
+} RegistryEntry;
+
+static _Atomic (RegistryEntry *) pages[REGISTRY_PAGES]; /* the entries */
+static _Atomic long used = 0;   /* entries handed out at least once */
+static long free_list = -1;     /* first free entry, or -1 */
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER; /* orders changes */
+
+static RegistryEntry * find_entry (long handle);
+
+
+/*----------------------------------------------------------------------------
+Function Name:          add_Registry
+Purpose:                This function gives a stack a handle
+Description:            This function takes the mutex and reuses a free entry
+                        if there is one, or else the first entry never used,
+                        allocating its page when it is the first of a page.
+                        The stack is stored in the entry and the handle is
+                        made from the entry's index and generation
+Input:                  this_Stack: the stack being added
+Result:                 The handle of the stack, or 0 if the stack does not
+                        exist or the registry is full or out of memory and
+                        an error message is printed
+----------------------------------------------------------------------------*/
+long add_Registry (Stack * this_Stack)
+{
+    RegistryEntry * page = 0;   /* page of the entry */
+    RegistryEntry * entry = 0;  /* entry given to the stack */
+    long index = 0;             /* index of that entry */
+
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (ADD_NONEXIST, stderr);      /* error message printed */
+        return 0;
+    }
+
+    pthread_mutex_lock (&lock);
+
+    /* If statement is executed if a removed stack left an entry free */
+    if (free_list >= 0)
+    {
+        index = free_list;
+        entry = find_entry (index);
+        free_list = entry->next;
+    }
+    else
+    {
+        index = atomic_load_explicit (&used, memory_order_relaxed);
+
+        /* If statement is executed if the registry still has room */
+        if (index < REGISTRY_PAGES * REGISTRY_PAGE)
+        {
+            page = atomic_load_explicit (&pages[index >> REGISTRY_PAGE_BITS],
+                                         memory_order_relaxed);
+        }
+
+        /* If statement is executed if the entry needs a new page */
+        if ( index < REGISTRY_PAGES * REGISTRY_PAGE && !page &&
+             (page = calloc (REGISTRY_PAGE, sizeof(RegistryEntry))) )
+        {
+            atomic_store_explicit (&pages[index >> REGISTRY_PAGE_BITS],
+                                   page, memory_order_release);
+        }
+
+        /* If statement is executed if the registry is full or the page
+         * could not be allocated */
+        if (index >= REGISTRY_PAGES * REGISTRY_PAGE || !page)
+        {
+            pthread_mutex_unlock (&lock);
+            writeline (ADD_FAILED, stderr);    /* error message printed */
+            return 0;
+        }
+
+        entry = page + (index & (REGISTRY_PAGE - 1));
+        atomic_store_explicit (&entry->generation, 1, memory_order_relaxed);
+        atomic_store_explicit (&used, index + 1, memory_order_release);
+    }
+
+    atomic_store_explicit (&entry->stack, this_Stack, memory_order_release);
+    pthread_mutex_unlock (&lock);
+
+    return atomic_load_explicit (&entry->generation, memory_order_relaxed)
+           << REGISTRY_INDEX_BITS | index;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          find_Registry
+Purpose:                This function finds the stack of a handle
+Description:            This function goes straight to the entry the handle
+                        names and reads its stack and then its generation.
+                        Since a removal changes the generation before it
+                        clears the stack, a stack read alongside the
+                        generation of the handle is the stack the handle was
+                        given for
+Input:                  handle: the handle of the stack
+Result:                 The stack, or NULL if the handle is unknown or its
+                        stack was removed and an error message is printed
+----------------------------------------------------------------------------*/
+Stack * find_Registry (long handle)
+{
+    RegistryEntry * entry = find_entry (handle);    /* entry of the handle */
+    Stack * this_Stack = 0;     /* the stack in the entry */
+
+    /* If statement is executed if the entry holds the stack of the handle */
+    if ( entry &&
+         (this_Stack = atomic_load_explicit (&entry->stack,
+                                             memory_order_acquire)) &&
+         atomic_load_explicit (&entry->generation, memory_order_acquire)
+         == handle >> REGISTRY_INDEX_BITS )
+    {
+        return this_Stack;
+    }
+
+    writeline (HANDLE_UNKNOWN, stderr);        /* error message printed */
+    return NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          next_Registry
+Purpose:                This function walks the stacks in the registry
+Description:            This function looks at the entries after the one the
+                        handle names, in index order, for one holding a
+                        stack. Starting from 0 and passing back each handle
+                        found visits every stack, and stacks may be added or
+                        removed along the way
+Input:                  handle: the handle to continue from, or 0
+Result:                 The handle of the next stack, or 0 if there is none
+----------------------------------------------------------------------------*/
+long next_Registry (long handle)
+{
+    RegistryEntry * entry = 0;  /* entry being looked at */
+    long index = handle > 0 ? (handle & REGISTRY_INDEX_MASK) + 1 : 0;
+    long count = atomic_load_explicit (&used, memory_order_acquire);
+
+    for (; index < count; index++)
+    {
+        entry = find_entry (index);
+
+        if ( atomic_load_explicit (&entry->stack, memory_order_acquire) )
+        {
+            return atomic_load_explicit (&entry->generation,
+                                         memory_order_acquire)
+                   << REGISTRY_INDEX_BITS | index;
+        }
+    }
+
+    return 0;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          remove_Registry
+Purpose:                This function takes a stack out of the registry
+Description:            This function takes the mutex and checks the handle.
+                        The entry is moved on to its next generation, which
+                        makes the handle stale, before its stack is cleared,
+                        and the entry is put on the free list for reuse
+Input:                  handle: the handle of the stack
+Result:                 The stack, which the caller still has to delete, or
+                        NULL if the handle is unknown or its stack was
+                        already removed and an error message is printed
+----------------------------------------------------------------------------*/
+Stack * remove_Registry (long handle)
+{
+    RegistryEntry * entry = find_entry (handle);    /* entry of the handle */
+    Stack * this_Stack = 0;     /* the stack in the entry */
+    long generation = 0;        /* generation of the entry */
+
+    pthread_mutex_lock (&lock);
+
+    /* If statement is executed if the entry holds the stack of the handle */
+    if ( entry &&
+         (this_Stack = atomic_load_explicit (&entry->stack,
+                                             memory_order_relaxed)) &&
+         (generation = atomic_load_explicit (&entry->generation,
+                                             memory_order_relaxed))
+         == handle >> REGISTRY_INDEX_BITS )
+    {
+        generation = generation < REGISTRY_GENERATIONS ? generation + 1 : 1;
+        atomic_store_explicit (&entry->generation, generation,
+                               memory_order_release);
+        atomic_store_explicit (&entry->stack, NULL, memory_order_release);
+        entry->next = free_list;
+        free_list = handle & REGISTRY_INDEX_MASK;
+        pthread_mutex_unlock (&lock);
+
+        return this_Stack;
+    }
+
+    pthread_mutex_unlock (&lock);
+    writeline (HANDLE_UNKNOWN, stderr);        /* error message printed */
+    return NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          set_Registry
+Purpose:                This function updates the stack of a handle
+Description:            This function takes the mutex, checks the handle and
+                        stores the stack in its entry, keeping the handle
+Input:                  handle: the handle of the stack
+                        this_Stack: the stack's new location
+Result:                 True if the stack was stored. False if the stack does
+                        not exist or the handle is unknown or its stack was
+                        removed and an error message is printed
+----------------------------------------------------------------------------*/
+long set_Registry (long handle, Stack * this_Stack)
+{
+    RegistryEntry * entry = find_entry (handle);    /* entry of the handle */
+
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (ADD_NONEXIST, stderr);      /* error message printed */
+        return 0;
+    }
+
+    pthread_mutex_lock (&lock);
+
+    /* If statement is executed if the entry holds the stack of the handle */
+    if ( entry &&
+         atomic_load_explicit (&entry->stack, memory_order_relaxed) &&
+         atomic_load_explicit (&entry->generation, memory_order_relaxed)
+         == handle >> REGISTRY_INDEX_BITS )
+    {
+        atomic_store_explicit (&entry->stack, this_Stack,
+                               memory_order_release);
+        pthread_mutex_unlock (&lock);
+
+        return 1;
+    }
+
+    pthread_mutex_unlock (&lock);
+    writeline (HANDLE_UNKNOWN, stderr);        /* error message printed */
+    return 0;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          find_entry
+Purpose:                This function finds the entry a handle names
+Description:            This function takes the index out of the handle, or
+                        uses a bare index as it is, and looks its page up.
+                        Only entries that have been handed out are found
+Input:                  handle: a handle or an index
+Result:                 The entry, or NULL if it was never handed out
+----------------------------------------------------------------------------*/
+static RegistryEntry * find_entry (long handle)
+{
+    long index = handle & REGISTRY_INDEX_MASK;  /* index of the entry */
+    RegistryEntry * page = 0;   /* page holding the entry */
+
+    /* If statement is executed if the entry was never handed out */
+    if ( handle < 0 ||
+         index >= atomic_load_explicit (&used, memory_order_acquire) )
+    {
+        return NULL;
+    }
+
+    page = atomic_load_explicit (&pages[index >> REGISTRY_PAGE_BITS],
+                                 memory_order_acquire);
+
+    return page + (index & (REGISTRY_PAGE - 1));
+}
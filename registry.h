@@ -0,0 +1,39 @@
+#ifndef REGISTRY_H
+#define REGISTRY_H
+
+#include "stack.h"
+
+/* The stack registry gives stacks stable integer handles, so that a
+program can keep thousands of stacks and name them by number.  A handle
+holds the index of the stack's entry in the registry and the generation
+the entry had when the stack was added.  Removing the stack moves the
+entry on to the next generation before the entry is reused, so a handle
+kept after its stack was removed no longer matches and is refused rather
+than reaching whichever stack took the entry next.  Entries live in pages
+that are never moved or freed, so finding a stack takes no lock; adding
+and removing stacks take a mutex and may be made from any thread.
+
+The registry holds the Stack pointer it is given.  A stack that moves in
+memory, through push_grow and the other growable functions, must be put
+back with set_Registry. */
+
+long add_Registry (Stack *);    /* adds the stack to the registry.  Result
+                                   is the new handle, always positive, or 0
+                                   on failure */
+Stack * find_Registry (long);   /* finds the stack of the handle.  Result
+                                   is the stack, or NULL if the handle is
+                                   unknown or its stack was removed */
+long next_Registry (long);      /* finds the next stack in the registry
+                                   after the handle, 0 starting from the
+                                   first.  Result is its handle, or 0 when
+                                   there are no more */
+Stack * remove_Registry (long); /* removes the stack of the handle from the
+                                   registry, without deleting it.  Result
+                                   is the stack, or NULL if the handle is
+                                   unknown or its stack was removed */
+long set_Registry (long, Stack *); /* replaces the stack of the handle,
+                                   after it has moved.  Result is 0 or
+                                   non-0 indicating failure or success,
+                                   respectively */
+
+#endif
@@ -0,0 +1,214 @@
+/******************************************************************************
+
+File Name:      ring.c
+Description:    This program implements a single-producer, single-consumer
+                ring of pointers that hands work from one thread to another
+                without a lock.  The slots are a power of two in number, so
+                the head and tail count up for ever and are reduced to a
+                slot with a mask.
+
+******************************************************************************/
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "mylib.h"
+#include "ring.h"
+
+#define CACHE_LINE 64                   /* bytes in a cache line */
+#define MAX_SLOTS (1UL << 30)           /* largest ring that can be made */
+
+/* catastrophic error messages */
+static const char ALLOCATE_FAILED[] = "Allocating a ring failed!!!\n";
+static const char DELETE_NONEXIST[] = "Deleting a non-existent ring!!!\n";
+static const char GET_NONEXIST[] = "Getting from a non-existent ring!!!\n";
+static const char PUT_NONEXIST[] = "Putting to a non-existent ring!!!\n";
+
+/* The consumer's fields and the producer's fields are each on their own
+ * cache line, so that neither thread's writes take the line the other is
+ * reading from it.  Each side's copy of the other index is only written
+ * by that side. */
+struct Ring
+{
+    _Alignas (CACHE_LINE) void ** slots;    /* the pointers */
+    unsigned long mask;                     /* slots - 1 */
+    _Alignas (CACHE_LINE) _Atomic unsigned long head; /* next to get */
+    unsigned long tail_seen;                /* the consumer's copy of tail */
+    _Alignas (CACHE_LINE) _Atomic unsigned long tail; /* next to put */
+    unsigned long head_seen;                /* the producer's copy of head */
+};
+
+
+/*----------------------------------------------------------------------------
+Function Name:          delete_Ring
+Purpose:                This function deletes a created ring
+Description:            This function checks to see if the ring exists. If
+                        not, an error message is printed. If so, the slots
+                        and the ring itself are deallocated and the caller's
+                        pointer is set to NULL. Pointers still in the ring
+                        are not followed
+Input:                  rpp: the ring from which we will deallocate memory
+Result:                 Deletes the created ring or prints an error message
+----------------------------------------------------------------------------*/
+void delete_Ring (Ring ** rpp)
+{
+    /* If statement is executed if rpp or the ring it points to does not
+     * exist */
+    if (!rpp || !*rpp)
+    {
+        writeline (DELETE_NONEXIST, stderr);   /* error message printed */
+        return;
+    }
+
+    free ((*rpp)->slots);
+    free (*rpp);
+    *rpp = NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          get_Ring
+Purpose:                This function removes the oldest pointer in the ring
+Description:            This function compares the head with its copy of the
+                        tail, and only when they are equal loads the tail
+                        again to see whether the producer has put more. The
+                        acquire load of the tail makes what the producer
+                        wrote before putting the pointer visible here, and
+                        the release store of the head gives the slot back
+Input:                  this_Ring: the ring in question
+                        item: the pointer removed
+Result:                 True if a pointer was removed. False if the ring is
+                        empty, or it or item does not exist and an error
+                        message is printed
+----------------------------------------------------------------------------*/
+long get_Ring (Ring * this_Ring, void ** item)
+{
+    unsigned long head = 0;     /* index of the slot to get */
+
+    /* If statement is executed if the ring or item is not yet set */
+    if (!this_Ring || !item)
+    {
+        writeline (GET_NONEXIST, stderr);      /* error message printed */
+        return 0;
+    }
+
+    head = atomic_load_explicit (&this_Ring->head, memory_order_relaxed);
+
+    /* If statement is executed if the ring looks empty, when the tail is
+     * read again in case the producer has moved it since */
+    if (head == this_Ring->tail_seen)
+    {
+        this_Ring->tail_seen = atomic_load_explicit (&this_Ring->tail,
+                                                     memory_order_acquire);
+
+        /* If statement is executed if the ring is still empty */
+        if (head == this_Ring->tail_seen)
+        {
+            return 0;
+        }
+    }
+
+    *item = this_Ring->slots[head & this_Ring->mask];
+    atomic_store_explicit (&this_Ring->head, head + 1, memory_order_release);
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          new_Ring
+Purpose:                This function allocates a ring
+Description:            This function rounds the number of slots up to a
+                        power of two and allocates the ring on its own cache
+                        lines and the slots after it, with the head and tail
+                        both at 0
+Input:                  slots: the fewest pointers the ring must hold
+Result:                 The new ring, or NULL if it is too large or memory
+                        could not be allocated and an error message is
+                        printed
+----------------------------------------------------------------------------*/
+Ring * new_Ring (unsigned long slots)
+{
+    Ring * this_Ring = 0;       /* the new ring */
+    unsigned long size = 1;     /* slots rounded up to a power of two */
+
+    /* If statement is executed if the ring would be too large */
+    if (slots > MAX_SLOTS)
+    {
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    while (size < slots)
+    {
+        size <<= 1;
+    }
+
+    this_Ring = aligned_alloc (CACHE_LINE, sizeof(Ring));
+
+    /* If statement is executed if the ring or its slots could not be
+     * allocated */
+    if ( !this_Ring ||
+         !(this_Ring->slots = malloc (size * sizeof(void *))) )
+    {
+        free (this_Ring);
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    this_Ring->mask = size - 1;
+    atomic_init (&this_Ring->head, 0);
+    atomic_init (&this_Ring->tail, 0);
+    this_Ring->tail_seen = 0;
+    this_Ring->head_seen = 0;
+
+    return this_Ring;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          put_Ring
+Purpose:                This function adds a pointer to the ring
+Description:            This function compares the tail with its copy of the
+                        head, and only when the ring looks full loads the
+                        head again to see whether the consumer has freed a
+                        slot. The pointer is stored in the slot before the
+                        release store of the tail publishes it
+Input:                  this_Ring: the ring in question
+                        item: the pointer being added
+Result:                 True if the pointer was added. False if the ring is
+                        full, or does not exist and an error message is
+                        printed
+----------------------------------------------------------------------------*/
+long put_Ring (Ring * this_Ring, void * item)
+{
+    unsigned long tail = 0;     /* index of the slot to put */
+
+    /* If statement is executed if the ring is not yet set */
+    if (!this_Ring)
+    {
+        writeline (PUT_NONEXIST, stderr);      /* error message printed */
+        return 0;
+    }
+
+    tail = atomic_load_explicit (&this_Ring->tail, memory_order_relaxed);
+
+    /* If statement is executed if the ring looks full, when the head is
+     * read again in case the consumer has moved it since */
+    if (tail - this_Ring->head_seen > this_Ring->mask)
+    {
+        this_Ring->head_seen = atomic_load_explicit (&this_Ring->head,
+                                                     memory_order_acquire);
+
+        /* If statement is executed if the ring is still full */
+        if (tail - this_Ring->head_seen > this_Ring->mask)
+        {
+            return 0;
+        }
+    }
+
+    this_Ring->slots[tail & this_Ring->mask] = item;
+    atomic_store_explicit (&this_Ring->tail, tail + 1, memory_order_release);
+
+    return 1;
+}
@@ -0,0 +1,31 @@
+#ifndef RING_H
+#define RING_H
+
+/* A ring is a bounded first in, first out queue of pointers between
+exactly one producing thread and one consuming thread.  It takes no lock:
+the producer alone moves the tail and the consumer alone moves the head,
+each on its own cache line, and each keeps a copy of the other's index so
+that it only reads the shared one when its copy says the ring is full or
+empty.  Putting and getting never block; a thread that finds the ring full
+or empty decides itself whether to retry, yield or sleep. */
+
+typedef struct Ring Ring;
+
+void delete_Ring (Ring **);     /* deallocates memory allocated in new_Ring.
+                                   Neither thread may still be using the
+                                   ring.  Assigns incoming pointer to
+                                   NULL. */
+long get_Ring (Ring *, void **); /* removes and sends back the oldest
+                                   pointer in the ring.  Only the consumer
+                                   may call it.  Result is 0 if the ring is
+                                   empty, non-0 on success */
+Ring * new_Ring (unsigned long); /* allocates a ring holding at least the
+                                   given number of pointers.  Result is the
+                                   new ring, or NULL if memory could not be
+                                   allocated */
+long put_Ring (Ring *, void *); /* adds the pointer, which may be NULL, to
+                                   the ring.  Only the producer may call it.
+                                   Result is 0 if the ring is full, non-0
+                                   on success */
+
+#endif
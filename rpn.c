@@ -0,0 +1,540 @@
+/******************************************************************************
+
+File Name:      rpn.c
+Description:    This program implements an evaluator of postfix programs
+                over the array-based stack in stack.c.  A program is
+                compiled once into bytecode, checked for underflow as it is
+                compiled, and run with threaded dispatch straight on the
+                stack's array, so running it costs no call or check for
+                each operand.
+
+******************************************************************************/
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mylib.h"
+#include "rpn.h"
+
+/* GCC and Clang can jump through a table of label addresses, which gives
+ * every operation its own indirect jump to the next one */
+#if defined(__GNUC__)
+#define RPN_THREADED
+#endif
+
+#define RPN_MAX_INPUTS (1L << 20)   /* most inputs a program may read */
+#define RPN_TOKEN 8                 /* longest operator, with its '\0' */
+
+/* the operations of the bytecode, CONST and INPUT being followed by their
+ * value and input index */
+enum { OP_END, OP_CONST, OP_INPUT, OP_ADD, OP_SUB, OP_MUL, OP_DIV, OP_MOD,
+       OP_NEG, OP_AND, OP_OR, OP_XOR, OP_NOT, OP_SHL, OP_SHR, OP_EQ, OP_NE,
+       OP_LT, OP_LE, OP_GT, OP_GE, OP_LAND, OP_LOR, OP_LNOT, OP_MIN, OP_MAX,
+       OP_DUP, OP_DROP, OP_SWAP, OP_OVER };
+
+/* catastrophic error messages */
+static const char ALLOCATE_FAILED[] =
+                        "Allocating an RPN program failed!!!\n";
+static const char DELETE_NONEXIST[] = "Deleting a non-existent program!!!\n";
+static const char DIVIDE_ZERO[] = "RPN program divides by zero!!!\n";
+static const char INCOMING_NONEXIST[] =
+                        "Incoming parameter does not exist!!!\n";
+static const char INPUT_RANGE[] = "RPN program input out of range!!!\n";
+static const char NO_RESULT[] = "RPN program leaves no result!!!\n";
+static const char OVERFLOW[] = "RPN program overflows the stack!!!\n";
+static const char TOKEN_UNKNOWN[] = "RPN program has an unknown token!!!\n";
+static const char UNDERFLOW[] = "RPN program underflows the stack!!!\n";
+
+/* an operator as written and what it does to the depth of the stack */
+typedef struct RPNOperator
+{
+    char name[RPN_TOKEN];       /* the token */
+    long op;                    /* its operation */
+    long pops;                  /* values it takes */
+    long pushes;                /* values it leaves */
+} RPNOperator;
+
+static const RPNOperator operators[] = {
+    { "+", OP_ADD, 2, 1 },      { "-", OP_SUB, 2, 1 },
+    { "*", OP_MUL, 2, 1 },      { "/", OP_DIV, 2, 1 },
+    { "%", OP_MOD, 2, 1 },      { "neg", OP_NEG, 1, 1 },
+    { "&", OP_AND, 2, 1 },      { "|", OP_OR, 2, 1 },
+    { "^", OP_XOR, 2, 1 },      { "~", OP_NOT, 1, 1 },
+    { "<<", OP_SHL, 2, 1 },     { ">>", OP_SHR, 2, 1 },
+    { "==", OP_EQ, 2, 1 },      { "!=", OP_NE, 2, 1 },
+    { "<", OP_LT, 2, 1 },       { "<=", OP_LE, 2, 1 },
+    { ">", OP_GT, 2, 1 },       { ">=", OP_GE, 2, 1 },
+    { "&&", OP_LAND, 2, 1 },    { "||", OP_LOR, 2, 1 },
+    { "!", OP_LNOT, 1, 1 },     { "min", OP_MIN, 2, 1 },
+    { "max", OP_MAX, 2, 1 },    { "dup", OP_DUP, 1, 2 },
+    { "drop", OP_DROP, 1, 0 },  { "swap", OP_SWAP, 2, 2 },
+    { "over", OP_OVER, 2, 3 }
+};
+
+/* A compiled program.  depth is the most values it has on the stack at
+ * once, which run_batch_RPN checks the stack has room for. */
+struct RPNProgram
+{
+    long * code;                /* the bytecode, ending in OP_END */
+    long depth;                 /* deepest the program goes */
+    long inputs;                /* longs in each input vector */
+};
+
+static long evaluate (const long * code, long * base, const long * inputs,
+                      long * result);
+
+
+/*----------------------------------------------------------------------------
+Function Name:          compile_RPN
+Purpose:                This function compiles an RPN program
+Description:            This function reads the text a token at a time, a
+                        token being a number, a $ input or an operator, and
+                        writes the bytecode for it. The depth of the stack
+                        is followed as the program is compiled, so that an
+                        operator taking more values than are on the stack
+                        is found here and the deepest point is known
+Input:                  text: the program
+Result:                 The compiled program, or NULL if the text does not
+                        exist, is not a valid program or memory could not be
+                        allocated and an error message is printed
+----------------------------------------------------------------------------*/
+RPNProgram * compile_RPN (const char * text)
+{
+    RPNProgram * program = 0;   /* the program being compiled */
+    const char * token = 0;     /* the token being compiled */
+    long length = 0;            /* characters in the token */
+    long written = 0;           /* longs of bytecode written */
+    long depth = 0;             /* values on the stack at this point */
+    long value = 0;             /* a number or input index */
+    unsigned long index = 0;    /* operator being compared */
+
+    /* If statement is executed if the text is not yet set */
+    if (!text)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return NULL;
+    }
+
+    program = calloc (1, sizeof(RPNProgram));
+
+    /* If statement is executed if the program could not be allocated, the
+     * bytecode never being longer than two longs for each character and
+     * the OP_END */
+    if ( !program ||
+         !(program->code = malloc ((2 * strlen (text) + 1) * sizeof(long))) )
+    {
+        free (program);
+        writeline (ALLOCATE_FAILED, stderr);    /* error message printed */
+        return NULL;
+    }
+
+    for (token = text; *token; token += length)
+    {
+        /* white space separates the tokens */
+        if ( isspace ((unsigned char) *token) )
+        {
+            length = 1;
+            continue;
+        }
+
+        for (length = 0; token[length] &&
+             !isspace ((unsigned char) token[length]); length++)
+        {
+        }
+
+        /* If statement is executed for a number */
+        if (sdecin (token, &value) == length)
+        {
+            program->code[written++] = OP_CONST;
+            program->code[written++] = value;
+            depth++;
+        }
+
+        /* If statement is executed for an input, $ and then digits */
+        else if ( *token == '$' && length > 1 &&
+                  isdigit ((unsigned char) token[1]) &&
+                  sdecin (token + 1, &value) == length - 1 )
+        {
+            /* If statement is executed if the input cannot be one */
+            if (value < 0 || value >= RPN_MAX_INPUTS)
+            {
+                writeline (INPUT_RANGE, stderr);   /* error message printed */
+                delete_RPN (&program);
+                return NULL;
+            }
+
+            program->code[written++] = OP_INPUT;
+            program->code[written++] = value;
+            program->inputs = value >= program->inputs ? value + 1 :
+                                                         program->inputs;
+            depth++;
+        }
+        else
+        {
+            for (index = 0; index < sizeof(operators) / sizeof(*operators);
+                 index++)
+            {
+                /* If statement is executed if the token names this
+                 * operator */
+                if ( length < RPN_TOKEN &&
+                     !strncmp (token, operators[index].name, length) &&
+                     !operators[index].name[length] )
+                {
+                    break;
+                }
+            }
+
+            /* If statement is executed if the token is no operator */
+            if ( index == sizeof(operators) / sizeof(*operators) )
+            {
+                writeline (TOKEN_UNKNOWN, stderr); /* error message printed */
+                delete_RPN (&program);
+                return NULL;
+            }
+
+            /* If statement is executed if the operator takes more values
+             * than the stack will hold */
+            if (depth < operators[index].pops)
+            {
+                writeline (UNDERFLOW, stderr);     /* error message printed */
+                delete_RPN (&program);
+                return NULL;
+            }
+
+            program->code[written++] = operators[index].op;
+            depth += operators[index].pushes - operators[index].pops;
+        }
+
+        /* keep the deepest point of the program */
+        if (depth > program->depth)
+        {
+            program->depth = depth;
+        }
+    }
+
+    /* If statement is executed if nothing is left to be the result */
+    if (depth < 1)
+    {
+        writeline (NO_RESULT, stderr);             /* error message printed */
+        delete_RPN (&program);
+        return NULL;
+    }
+
+    program->code[written] = OP_END;
+
+    return program;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          delete_RPN
+Purpose:                This function deletes a compiled program
+Description:            This function checks to see if the program exists.
+                        If not, an error message is printed. If so, its
+                        bytecode and the program are deallocated and the
+                        caller's pointer is set to NULL
+Input:                  ppp: the program from which we will deallocate memory
+Result:                 Deletes the program or prints an error message
+----------------------------------------------------------------------------*/
+void delete_RPN (RPNProgram ** ppp)
+{
+    /* If statement is executed if ppp or the program it points to does not
+     * exist */
+    if (!ppp || !*ppp)
+    {
+        writeline (DELETE_NONEXIST, stderr);   /* error message printed */
+        return;
+    }
+
+    free ((*ppp)->code);
+    free (*ppp);
+    *ppp = NULL;
+}
+
+
+/* the width of the input vectors, 0 for no program */
+long inputs_RPN (RPNProgram * program)
+{
+    return program ? program->inputs : 0;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          run_batch_RPN
+Purpose:                This function runs a program over many input vectors
+Description:            This function checks once that the stack has room
+                        above its elements for the deepest point of the
+                        program, and then evaluates the program on each
+                        input vector in turn in that room. The stack's own
+                        elements and stack pointer are left unaffected
+Input:                  program: the compiled program
+                        this_Stack: the stack the program runs on
+                        inputs: count vectors of inputs_RPN longs each
+                        count: the number of vectors
+                        results: count longs for the results
+Result:                 The number of results stored. Fewer than count if a
+                        run divided by 0, and 0 if anything does not exist
+                        or the stack is too small, and an error message is
+                        printed
+----------------------------------------------------------------------------*/
+long run_batch_RPN (RPNProgram * program, Stack * this_Stack,
+                    const long * inputs, unsigned long count, long * results)
+{
+    long * base = 0;            /* first free long of the stack */
+    unsigned long index = 0;    /* vector being evaluated */
+
+    /* If statement is executed if anything is not yet set */
+    if ( !program || !this_Stack || !results ||
+         (!inputs && program->inputs && count) )
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the stack has no room for the program */
+    if (this_Stack[STACK_SIZE_INDEX] - this_Stack[STACK_POINTER_INDEX] - 1
+        < program->depth)
+    {
+        writeline (OVERFLOW, stderr);           /* error message printed */
+        return 0;
+    }
+
+    base = this_Stack + this_Stack[STACK_POINTER_INDEX] + 1;
+
+    for (index = 0; index < count; index++)
+    {
+        /* If statement is executed if the run failed */
+        if ( !evaluate (program->code, base, inputs, results + index) )
+        {
+            writeline (DIVIDE_ZERO, stderr);    /* error message printed */
+            break;
+        }
+
+        inputs += program->inputs;
+    }
+
+    return index;
+}
+
+
+/* runs the program once, as run_batch_RPN does */
+long run_RPN (RPNProgram * program, Stack * this_Stack, const long * inputs,
+              long * result)
+{
+    return run_batch_RPN (program, this_Stack, inputs, 1, result) == 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          evaluate
+Purpose:                This function runs the bytecode once
+Description:            This function keeps the top of the stack in a local
+                        pointer and carries out each operation in turn. With
+                        threaded dispatch each operation ends by jumping
+                        straight to the code of the next, and otherwise a
+                        switch in a loop is used. Arithmetic is done on
+                        unsigned longs so that overflow wraps around, even
+                        for LONG_MIN divided by -1, and division by 0 fails
+Input:                  code: the bytecode
+                        base: where the program's stack begins
+                        inputs: the input vector
+                        result: the value on top at the end
+Result:                 True if the program ran. False if it divided by 0
+----------------------------------------------------------------------------*/
+static long evaluate (const long * code, long * base, const long * inputs,
+                      long * result)
+{
+    long * top = base - 1;      /* the top of the program's stack */
+    long value = 0;             /* a value being moved */
+
+#ifdef RPN_THREADED
+    static const void * const labels[] = {
+        &&op_END, &&op_CONST, &&op_INPUT, &&op_ADD, &&op_SUB, &&op_MUL,
+        &&op_DIV, &&op_MOD, &&op_NEG, &&op_AND, &&op_OR, &&op_XOR,
+        &&op_NOT, &&op_SHL, &&op_SHR, &&op_EQ, &&op_NE, &&op_LT, &&op_LE,
+        &&op_GT, &&op_GE, &&op_LAND, &&op_LOR, &&op_LNOT, &&op_MIN,
+        &&op_MAX, &&op_DUP, &&op_DROP, &&op_SWAP, &&op_OVER
+    };
+#define OPERATION(name) op_##name
+#define NEXT goto *labels[*code++]
+
+    NEXT;
+#else
+#define OPERATION(name) case OP_##name
+#define NEXT continue
+
+    for (;;) switch (*code++) {
+#endif
+
+    OPERATION(END):
+        *result = *top;
+        return 1;
+
+    OPERATION(CONST):
+        *++top = *code++;
+        NEXT;
+
+    OPERATION(INPUT):
+        *++top = inputs[*code++];
+        NEXT;
+
+    OPERATION(ADD):
+        top--;
+        *top = (long)((unsigned long)top[0] + (unsigned long)top[1]);
+        NEXT;
+
+    OPERATION(SUB):
+        top--;
+        *top = (long)((unsigned long)top[0] - (unsigned long)top[1]);
+        NEXT;
+
+    OPERATION(MUL):
+        top--;
+        *top = (long)((unsigned long)top[0] * (unsigned long)top[1]);
+        NEXT;
+
+    OPERATION(DIV):
+        top--;
+
+        /* If statement is executed if the quotient does not exist */
+        if (!top[1])
+        {
+            return 0;
+        }
+
+        /* If statement is executed for -1, which may overflow, when the
+         * quotient is the wrapped negation */
+        if (top[1] == -1)
+        {
+            *top = (long)(0 - (unsigned long)top[0]);
+            NEXT;
+        }
+        *top = top[0] / top[1];
+        NEXT;
+
+    OPERATION(MOD):
+        top--;
+
+        /* If statement is executed if the remainder does not exist */
+        if (!top[1])
+        {
+            return 0;
+        }
+        *top = top[1] == -1 ? 0 : top[0] % top[1];
+        NEXT;
+
+    OPERATION(NEG):
+        *top = (long)(0 - (unsigned long)*top);
+        NEXT;
+
+    OPERATION(AND):
+        top--;
+        *top = top[0] & top[1];
+        NEXT;
+
+    OPERATION(OR):
+        top--;
+        *top = top[0] | top[1];
+        NEXT;
+
+    OPERATION(XOR):
+        top--;
+        *top = top[0] ^ top[1];
+        NEXT;
+
+    OPERATION(NOT):
+        *top = ~*top;
+        NEXT;
+
+    OPERATION(SHL):
+        top--;
+        *top = (long)((unsigned long)top[0] << (top[1] & 63));
+        NEXT;
+
+    OPERATION(SHR):
+        top--;
+        *top = top[0] >> (top[1] & 63);
+        NEXT;
+
+    OPERATION(EQ):
+        top--;
+        *top = top[0] == top[1];
+        NEXT;
+
+    OPERATION(NE):
+        top--;
+        *top = top[0] != top[1];
+        NEXT;
+
+    OPERATION(LT):
+        top--;
+        *top = top[0] < top[1];
+        NEXT;
+
+    OPERATION(LE):
+        top--;
+        *top = top[0] <= top[1];
+        NEXT;
+
+    OPERATION(GT):
+        top--;
+        *top = top[0] > top[1];
+        NEXT;
+
+    OPERATION(GE):
+        top--;
+        *top = top[0] >= top[1];
+        NEXT;
+
+    OPERATION(LAND):
+        top--;
+        *top = top[0] && top[1];
+        NEXT;
+
+    OPERATION(LOR):
+        top--;
+        *top = top[0] || top[1];
+        NEXT;
+
+    OPERATION(LNOT):
+        *top = !*top;
+        NEXT;
+
+    OPERATION(MIN):
+        top--;
+        *top = top[1] < top[0] ? top[1] : top[0];
+        NEXT;
+
+    OPERATION(MAX):
+        top--;
+        *top = top[1] > top[0] ? top[1] : top[0];
+        NEXT;
+
+    OPERATION(DUP):
+        top[1] = top[0];
+        top++;
+        NEXT;
+
+    OPERATION(DROP):
+        top--;
+        NEXT;
+
+    OPERATION(SWAP):
+        value = top[0];
+        top[0] = top[-1];
+        top[-1] = value;
+        NEXT;
+
+    OPERATION(OVER):
+        top[1] = top[-1];
+        top++;
+        NEXT;
+
+#ifndef RPN_THREADED
+    }
+#endif
+
+#undef OPERATION
+#undef NEXT
+}
@@ -0,0 +1,49 @@
+#ifndef RPN_H
+#define RPN_H
+
+#include "stack.h"
+
+/* The RPN evaluator runs postfix programs over a Stack of longs.  A program
+is text of tokens separated by white space, each a decimal number, an input
+$0, $1 ... taken from the vector the program is run on, or an operator:
+
+    + - * / %           arithmetic, wrapping around on overflow
+    neg                 negation
+    & | ^ ~ << >>       bitwise operations, shifts counting modulo 64
+    == != < <= > >=     comparisons, giving 1 or 0
+    && || !             logic, non-0 being true
+    min max             the smaller or larger of two
+    dup drop swap over  stack manipulation
+
+compile_RPN turns the text into bytecode once.  Since a program has no
+branches, how deep it goes is known then, so an operator taking more than
+is on the stack is reported as underflow when compiling, and a stack too
+small for the program as overflow before it runs, instead of checking
+every operation.  The program runs in the free space above the stack's
+elements, which it leaves as they were, and its result is its top value. */
+
+typedef struct RPNProgram RPNProgram;
+
+RPNProgram * compile_RPN (const char *); /* compiles the program text.
+                                   Result is the program, or NULL if the
+                                   text is not a valid program */
+void delete_RPN (RPNProgram **); /* deallocates memory allocated in
+                                   compile_RPN.  Assigns incoming pointer
+                                   to NULL. */
+long inputs_RPN (RPNProgram *); /* returns the number of longs in each
+                                   input vector, one more than the highest
+                                   $ input the program reads */
+long run_batch_RPN (RPNProgram *, Stack *, const long *, unsigned long,
+                    long *); /* runs the program on the stack once for
+                                   each of the given number of input
+                                   vectors, which follow one another in the
+                                   inputs, storing each result.  Result is
+                                   the number of results stored, fewer than
+                                   asked for if a run divides by 0 */
+long run_RPN (RPNProgram *, Stack *, const long *, long *); /* runs the
+                                   program on the stack with one input
+                                   vector and sends back its result.
+                                   Result is 0 or non-0 indicating failure
+                                   or success, respectively */
+
+#endif
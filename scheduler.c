@@ -0,0 +1,518 @@
+/******************************************************************************
+
+File Name:      scheduler.c
+Description:    This program implements a pool of worker threads that run
+                tasks spawned by other tasks.  Every worker owns a
+                work-stealing deque from wsdeque.c, pushes the tasks it
+                spawns there and pops them back newest first.  A worker with
+                an empty deque steals the oldest task of a randomly chosen
+                worker, and a run ends when the count of tasks not yet
+                finished falls to zero.  Between runs the workers sleep on a
+                condition variable.
+
+******************************************************************************/
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "mylib.h"
+#include "scheduler.h"
+#include "wsdeque.h"
+
+#define CACHE_LINE 64       /* bytes in a cache line */
+#define DEQUE_SIZE 64       /* tasks a deque holds before it first grows */
+#define IDLE_SPINS 64       /* failed sweeps of the victims before yielding */
+
+/* catastrophic error messages */
+static const char ALLOCATE_FAILED[] =
+                        "Allocating a scheduler failed!!!\n";
+static const char DELETE_NONEXIST[] =
+                        "Deleting a non-existent scheduler!!!\n";
+static const char DELETE_RUNNING[] =
+                        "Deleting a scheduler from its own task!!!\n";
+static const char QUEUE_FAILED[] = "Queuing a scheduler's task failed!!!\n";
+static const char RUN_NESTED[] = "Running a scheduler from a task!!!\n";
+static const char RUN_NONEXIST[] = "Running a non-existent scheduler!!!\n";
+static const char SPAWN_NONEXIST[] =
+                        "Spawning on a non-existent scheduler!!!\n";
+static const char SPAWN_OUTSIDE[] =
+                        "Spawning outside the scheduler's tasks!!!\n";
+
+/* One worker of the pool, on cache lines of its own.  Only the worker
+ * itself changes its fields while a run is going on. */
+typedef struct Worker
+{
+    _Alignas (CACHE_LINE) WSDeque * deque;  /* the tasks it spawned */
+    Scheduler * scheduler;                  /* the pool it is part of */
+    unsigned long index;                    /* its place in the pool */
+    unsigned long seed;                     /* picks the victims to steal */
+    long ran;                               /* tasks run in this run */
+    pthread_t thread;                       /* its thread, but for worker 0 */
+} Worker;
+
+/* The workers and what wakes them.  The generation counts the runs, so a
+ * worker waking up can tell a new run from a spurious wake-up.  The count
+ * of pending tasks is on its own cache line since every task changes it. */
+struct Scheduler
+{
+    Task task;                      /* the function run for every task */
+    void * context;                 /* given to new_Scheduler */
+    unsigned long workers;          /* number of workers */
+    Worker * worker;                /* the workers */
+    pthread_mutex_t lock;           /* guards the fields below it */
+    pthread_cond_t wake;            /* signals a new run or stopping */
+    pthread_cond_t done;            /* signals the last worker finishing */
+    long generation;                /* number of runs started */
+    unsigned long finished;         /* threads done with this run */
+    long stopping;                  /* whether the threads should exit */
+    _Alignas (CACHE_LINE) _Atomic long pending; /* tasks not yet finished */
+};
+
+static _Thread_local Worker * current = 0;  /* worker this thread is being */
+
+static long find_task (Worker * this_Worker, long * task);
+static void free_Scheduler (Scheduler * this_Scheduler);
+static void * run_thread (void * argument);
+static void stop_workers (Scheduler * this_Scheduler, unsigned long started);
+static void work (Worker * this_Worker);
+
+
+/* the context given to new_Scheduler, or NULL */
+void * context_Scheduler (Scheduler * this_Scheduler)
+{
+    return this_Scheduler ? this_Scheduler->context : NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          delete_Scheduler
+Purpose:                This function deletes a created scheduler
+Description:            This function checks to see if the scheduler exists
+                        and is not being deleted from one of its own tasks.
+                        If so, the worker threads are woken to exit and
+                        joined, and the deques, the workers and the
+                        scheduler itself are deallocated and the caller's
+                        pointer is set to NULL
+Input:                  spp: the scheduler from which we will deallocate
+                             memory
+Result:                 Deletes the created scheduler or prints an error
+                        message
+----------------------------------------------------------------------------*/
+void delete_Scheduler (Scheduler ** spp)
+{
+    /* If statement is executed if spp or the scheduler it points to does
+     * not exist */
+    if (!spp || !*spp)
+    {
+        writeline (DELETE_NONEXIST, stderr);   /* error message printed */
+        return;
+    }
+
+    /* If statement is executed if one of the scheduler's tasks is running
+     * on this thread */
+    if (current && current->scheduler == *spp)
+    {
+        writeline (DELETE_RUNNING, stderr);    /* error message printed */
+        return;
+    }
+
+    stop_workers (*spp, (*spp)->workers);
+    free_Scheduler (*spp);
+    *spp = NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          new_Scheduler
+Purpose:                This function allocates a scheduler and starts its
+                        workers
+Description:            This function allocates the scheduler and one worker
+                        with a deque for each thread, then starts a thread
+                        for every worker but worker 0, which is whatever
+                        thread calls run_Scheduler. The threads wait for the
+                        first run
+Input:                  workers: number of workers, at least 1
+                        task: the function run for every task
+                        context: anything the task function needs, sent back
+                                 by context_Scheduler
+Result:                 The new scheduler, or NULL if there are no workers or
+                        task function, or memory or a thread could not be
+                        had, and an error message is printed
+----------------------------------------------------------------------------*/
+Scheduler * new_Scheduler (unsigned long workers, Task task, void * context)
+{
+    Scheduler * this_Scheduler = 0; /* the new scheduler */
+    unsigned long index = 0;        /* index of the worker being set up */
+    long failed = 0;                /* whether a deque was not allocated */
+
+    /* If statement is executed if there is nothing to run the tasks */
+    if (!workers || !task ||
+        !(this_Scheduler = aligned_alloc (CACHE_LINE, sizeof(Scheduler))))
+    {
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    this_Scheduler->task = task;
+    this_Scheduler->context = context;
+    this_Scheduler->workers = workers;
+    this_Scheduler->worker = aligned_alloc (CACHE_LINE,
+                                            workers * sizeof(Worker));
+    this_Scheduler->generation = 0;
+    this_Scheduler->finished = 0;
+    this_Scheduler->stopping = 0;
+    atomic_init (&this_Scheduler->pending, 0);
+    pthread_mutex_init (&this_Scheduler->lock, NULL);
+    pthread_cond_init (&this_Scheduler->wake, NULL);
+    pthread_cond_init (&this_Scheduler->done, NULL);
+
+    /* If statement is executed if the workers could not be allocated */
+    if (!this_Scheduler->worker)
+    {
+        this_Scheduler->workers = 0;
+        free_Scheduler (this_Scheduler);
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    for (index = 0; index < workers; index++)
+    {
+        this_Scheduler->worker[index].deque = new_WSDeque (DEQUE_SIZE);
+        this_Scheduler->worker[index].scheduler = this_Scheduler;
+        this_Scheduler->worker[index].index = index;
+        this_Scheduler->worker[index].seed = index * 2 + 1;
+        this_Scheduler->worker[index].ran = 0;
+        failed |= !this_Scheduler->worker[index].deque;
+    }
+
+    /* start the threads, stopping at the first that cannot be started */
+    for (index = 1; !failed && index < workers; index++)
+    {
+        failed = pthread_create (&this_Scheduler->worker[index].thread, NULL,
+                                 run_thread, this_Scheduler->worker + index);
+    }
+
+    /* If statement is executed if a deque or a thread could not be had */
+    if (failed)
+    {
+        stop_workers (this_Scheduler, index ? index - 1 : 0);
+        free_Scheduler (this_Scheduler);
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    return this_Scheduler;
+}
+
+
+/* the tasks a worker ran in the last run, or 0 */
+long ran_Scheduler (Scheduler * this_Scheduler, unsigned long worker)
+{
+    return this_Scheduler && worker < this_Scheduler->workers ?
+           this_Scheduler->worker[worker].ran : 0;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          run_Scheduler
+Purpose:                This function runs a task and all the tasks it spawns
+Description:            This function puts the task on worker 0's deque with
+                        one task pending, wakes the threads for a new run and
+                        works as worker 0 itself. Once no task is pending it
+                        waits for the other threads to finish the run, so
+                        that their counts are final and the next run starts
+                        with every worker idle
+Input:                  this_Scheduler: the scheduler in question
+                        task: the first task
+Result:                 True once every task has run. False if the scheduler
+                        does not exist, this thread is running one of its
+                        tasks or the task could not be queued, and an error
+                        message is printed
+----------------------------------------------------------------------------*/
+long run_Scheduler (Scheduler * this_Scheduler, long task)
+{
+    unsigned long index = 0;        /* index of the worker being reset */
+
+    /* If statement is executed if the scheduler is not yet set */
+    if (!this_Scheduler)
+    {
+        writeline (RUN_NONEXIST, stderr);      /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if this thread is already a worker */
+    if (current)
+    {
+        writeline (RUN_NESTED, stderr);        /* error message printed */
+        return 0;
+    }
+
+    for (index = 0; index < this_Scheduler->workers; index++)
+    {
+        this_Scheduler->worker[index].ran = 0;
+    }
+
+    /* If statement is executed if the first task cannot be queued */
+    if ( !push_WSDeque (this_Scheduler->worker[0].deque, task) )
+    {
+        writeline (QUEUE_FAILED, stderr);      /* error message printed */
+        return 0;
+    }
+
+    atomic_store_explicit (&this_Scheduler->pending, 1, memory_order_relaxed);
+
+    pthread_mutex_lock (&this_Scheduler->lock);
+    this_Scheduler->finished = 0;
+    this_Scheduler->generation++;
+    pthread_cond_broadcast (&this_Scheduler->wake);
+    pthread_mutex_unlock (&this_Scheduler->lock);
+
+    work (this_Scheduler->worker);
+
+    pthread_mutex_lock (&this_Scheduler->lock);
+    while (this_Scheduler->finished < this_Scheduler->workers - 1)
+    {
+        pthread_cond_wait (&this_Scheduler->done, &this_Scheduler->lock);
+    }
+    pthread_mutex_unlock (&this_Scheduler->lock);
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          spawn_Scheduler
+Purpose:                This function adds a task to the running worker
+Description:            This function counts the task as pending before
+                        pushing it on the deque of the worker running the
+                        calling task, so the count cannot reach zero while
+                        the task waits. When the deque cannot grow the task
+                        is run at once instead, which needs no memory
+Input:                  this_Scheduler: the scheduler in question
+                        task: the task being added
+Result:                 True if the task was added or run. False if the
+                        scheduler does not exist or this thread is not
+                        running one of its tasks, and an error message is
+                        printed
+----------------------------------------------------------------------------*/
+long spawn_Scheduler (Scheduler * this_Scheduler, long task)
+{
+    Worker * this_Worker = current;     /* worker running the caller */
+
+    /* If statement is executed if the scheduler is not yet set */
+    if (!this_Scheduler)
+    {
+        writeline (SPAWN_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if this thread is not running one of the
+     * scheduler's tasks */
+    if (!this_Worker || this_Worker->scheduler != this_Scheduler)
+    {
+        writeline (SPAWN_OUTSIDE, stderr);     /* error message printed */
+        return 0;
+    }
+
+    atomic_fetch_add_explicit (&this_Scheduler->pending, 1,
+                               memory_order_relaxed);
+
+    /* If statement is executed if the deque is full and cannot grow */
+    if ( !push_WSDeque (this_Worker->deque, task) )
+    {
+        this_Scheduler->task (this_Scheduler, task);
+        this_Worker->ran++;
+        atomic_fetch_sub_explicit (&this_Scheduler->pending, 1,
+                                   memory_order_release);
+    }
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          find_task
+Purpose:                This function steals a task from another worker
+Description:            This function visits every other worker once,
+                        starting at a random one so that idle workers do not
+                        all fall on the same victim, and steals the oldest
+                        task of the first that has one. A steal that loses a
+                        race moves on to the next victim
+Input:                  this_Worker: the worker looking for a task
+                        task: the task stolen
+Result:                 True if a task was stolen, false if none was found
+----------------------------------------------------------------------------*/
+static long find_task (Worker * this_Worker, long * task)
+{
+    Scheduler * this_Scheduler = this_Worker->scheduler;
+    unsigned long others = this_Scheduler->workers - 1; /* possible victims */
+    unsigned long start = 0;        /* first victim, counting from self */
+    unsigned long index = 0;        /* victim being visited */
+
+    /* If statement is executed if there is no one to steal from */
+    if (!others)
+    {
+        return 0;
+    }
+
+    this_Worker->seed ^= this_Worker->seed << 13;
+    this_Worker->seed ^= this_Worker->seed >> 7;
+    this_Worker->seed ^= this_Worker->seed << 17;
+    start = this_Worker->seed % others;
+
+    for (index = 0; index < others; index++)
+    {
+        Worker * victim = this_Scheduler->worker +
+                          (this_Worker->index + 1 + (start + index) % others)
+                          % this_Scheduler->workers;
+
+        /* If statement is executed if a task was stolen */
+        if (steal_WSDeque (victim->deque, task) == 1)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+
+/* deallocates the deques, workers and scheduler of stopped workers */
+static void free_Scheduler (Scheduler * this_Scheduler)
+{
+    unsigned long index = 0;    /* index of the worker being freed */
+
+    for (index = 0; index < this_Scheduler->workers; index++)
+    {
+        /* If statement is executed if the worker's deque was allocated */
+        if (this_Scheduler->worker[index].deque)
+        {
+            delete_WSDeque (&this_Scheduler->worker[index].deque);
+        }
+    }
+
+    pthread_mutex_destroy (&this_Scheduler->lock);
+    pthread_cond_destroy (&this_Scheduler->wake);
+    pthread_cond_destroy (&this_Scheduler->done);
+    free (this_Scheduler->worker);
+    free (this_Scheduler);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          run_thread
+Purpose:                This function is the body of a worker thread
+Description:            This function sleeps until a run starts or the
+                        scheduler stops. For each run it works until no task
+                        is pending, then counts itself finished, waking
+                        run_Scheduler when it is the last thread to finish
+Input:                  argument: the Worker this thread is
+Result:                 NULL once the scheduler stops
+----------------------------------------------------------------------------*/
+static void * run_thread (void * argument)
+{
+    Worker * this_Worker = argument;    /* the worker this thread is */
+    Scheduler * this_Scheduler = this_Worker->scheduler;
+    long seen = 0;                      /* the last run worked on */
+
+    pthread_mutex_lock (&this_Scheduler->lock);
+
+    for (;;)
+    {
+        while (!this_Scheduler->stopping &&
+               this_Scheduler->generation == seen)
+        {
+            pthread_cond_wait (&this_Scheduler->wake, &this_Scheduler->lock);
+        }
+
+        /* If statement is executed if the scheduler is being deleted */
+        if (this_Scheduler->stopping)
+        {
+            break;
+        }
+
+        seen = this_Scheduler->generation;
+        pthread_mutex_unlock (&this_Scheduler->lock);
+        work (this_Worker);
+        pthread_mutex_lock (&this_Scheduler->lock);
+
+        /* If statement is executed if this is the last thread to finish */
+        if (++this_Scheduler->finished == this_Scheduler->workers - 1)
+        {
+            pthread_cond_signal (&this_Scheduler->done);
+        }
+    }
+
+    pthread_mutex_unlock (&this_Scheduler->lock);
+
+    return NULL;
+}
+
+
+/* wakes the first started threads after worker 0 to exit and joins them */
+static void stop_workers (Scheduler * this_Scheduler, unsigned long started)
+{
+    unsigned long index = 0;    /* index of the worker being joined */
+
+    pthread_mutex_lock (&this_Scheduler->lock);
+    this_Scheduler->stopping = 1;
+    pthread_cond_broadcast (&this_Scheduler->wake);
+    pthread_mutex_unlock (&this_Scheduler->lock);
+
+    for (index = 1; index < started; index++)
+    {
+        pthread_join (this_Scheduler->worker[index].thread, NULL);
+    }
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          work
+Purpose:                This function runs tasks until none is pending
+Description:            This function pops the worker's own newest task, or
+                        failing that steals one, and runs it. A task is
+                        counted finished only after it has run, by which
+                        time the tasks it spawned are counted as pending. A
+                        worker that finds nothing spins over the victims
+                        for IDLE_SPINS sweeps and then yields the processor
+                        between sweeps
+Input:                  this_Worker: the worker doing the work
+Result:                 Returns once no task is pending
+----------------------------------------------------------------------------*/
+static void work (Worker * this_Worker)
+{
+    Scheduler * this_Scheduler = this_Worker->scheduler;
+    long task = 0;                  /* the task being run */
+    long spins = 0;                 /* sweeps that found no task */
+
+    current = this_Worker;
+
+    for (;;)
+    {
+        /* If statement is executed if a task was found */
+        if ( pop_WSDeque (this_Worker->deque, &task) ||
+             find_task (this_Worker, &task) )
+        {
+            this_Scheduler->task (this_Scheduler, task);
+            this_Worker->ran++;
+            atomic_fetch_sub_explicit (&this_Scheduler->pending, 1,
+                                       memory_order_release);
+            spins = 0;
+        }
+        /* If statement is executed if every task has finished */
+        else if ( !atomic_load_explicit (&this_Scheduler->pending,
+                                         memory_order_acquire) )
+        {
+            break;
+        }
+        /* If statement is executed if the worker has spun long enough */
+        else if (++spins > IDLE_SPINS)
+        {
+            sched_yield ();
+        }
+    }
+
+    current = NULL;
+}
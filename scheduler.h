@@ -0,0 +1,43 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+/* This scheduler runs tasks on a fixed pool of worker threads.  A task is
+a long handed to the scheduler's task function, which may spawn more tasks.
+Each worker keeps the tasks it spawns on a work-stealing deque of its own
+(wsdeque.h) and runs the newest of them first, as a stack would.  A worker
+that runs out of tasks steals the oldest task of another worker, so the
+work spreads over the pool without a lock shared by all the workers. */
+
+typedef struct Scheduler Scheduler;
+
+/* the function run for every task, given its scheduler and the task */
+typedef void (* Task) (Scheduler *, long);
+
+void * context_Scheduler (Scheduler *); /* sends back the context given to
+                                   new_Scheduler */
+void delete_Scheduler (Scheduler **); /* stops the worker threads and
+                                   deallocates memory allocated in
+                                   new_Scheduler.  Must not be called from
+                                   a task.  Assigns incoming pointer to
+                                   NULL. */
+Scheduler * new_Scheduler (unsigned long, Task, void *); /* starts the given
+                                   number of workers, less the one that
+                                   run_Scheduler's caller becomes, to run
+                                   the task function with the context.
+                                   Result is the new scheduler, or NULL if
+                                   it could not be made */
+long ran_Scheduler (Scheduler *, unsigned long); /* sends back the number
+                                   of tasks the given worker ran in the
+                                   last run_Scheduler, or 0 */
+long run_Scheduler (Scheduler *, long); /* runs the task and every task it
+                                   spawns, with the caller as worker 0, and
+                                   returns once all are done.  Result is 0
+                                   or non-0 indicating failure or success,
+                                   respectively */
+long spawn_Scheduler (Scheduler *, long); /* from within a task, adds a task
+                                   to the running worker's deque, or runs
+                                   it at once if the deque cannot grow.
+                                   Result is 0 or non-0 indicating failure
+                                   or success, respectively */
+
+#endif
@@ -0,0 +1,416 @@
+/******************************************************************************
+
+File Name:      segstack.c
+Description:    This program implements a segmented stack of longs that can
+                grow without limit.  Elements are kept in chunks of a fixed
+                number of longs linked from the top chunk down, so a push
+                never copies the elements beneath it and a deep stack only
+                holds the chunks it is using plus one spare.
+
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "mylib.h"
+#include "segstack.h"
+
+#define SEG_CHUNK 1024          /* longs in a chunk when none are asked for */
+
+/* catastrophic error messages */
+static const char ALLOCATE_FAILED[] =
+                        "Allocating a segmented stack failed!!!\n";
+static const char DELETE_NONEXIST[] = "Deleting a non-existent stack!!!\n";
+static const char EMPTY_NONEXIST[] = "Emptying a non-existent stack!!!\n";
+static const char INCOMING_NONEXIST[] =
+                        "Incoming parameter does not exist!!!\n";
+static const char ISEMPTY_NONEXIST[] =
+                        "Isempty check from a non-existent stack!!!\n";
+static const char NUM_NONEXIST[] =
+                        "Num_elements check from a non-existent stack!!!\n";
+static const char POP_EMPTY[] = "Popping from an empty stack!!!\n";
+static const char POP_NONEXIST[] = "Popping from a non-existent stack!!!\n";
+static const char PUSH_FULL[] = "Pushing to a full stack!!!\n";
+static const char PUSH_NONEXIST[] = "Pushing to a non-existent stack!!!\n";
+static const char TOP_EMPTY[] = "Topping from an empty stack!!!\n";
+static const char TOP_NONEXIST[] = "Topping from a non-existent stack!!!\n";
+
+/* A chunk of elements and the link to the chunk below it. */
+typedef struct SegChunk
+{
+    struct SegChunk * below;    /* next chunk down, NULL for the bottom */
+    long values[];              /* the elements, bottom first */
+} SegChunk;
+
+/* The top chunk is only ever empty when it is also the bottom chunk, since
+ * a pop that empties any other chunk steps down to the chunk below. */
+struct SegStack
+{
+    SegChunk * chunk;           /* chunk holding the top element */
+    SegChunk * spare;           /* empty chunk kept for the next push */
+    unsigned long used;         /* elements in the top chunk */
+    unsigned long size;         /* longs in every chunk */
+    long count;                 /* elements on the whole stack */
+};
+
+static SegChunk * new_chunk (unsigned long size);
+
+
+/*----------------------------------------------------------------------------
+Function Name:          delete_SegStack
+Purpose:                This function deletes a created segmented stack
+Description:            This function checks to see if the stack exists. If
+                        not, an error message is printed. If so, every chunk
+                        from the top down, the spare chunk and the stack
+                        itself are deallocated and the caller's pointer is
+                        set to NULL
+Input:                  spp: the stack from which we will deallocate memory
+Result:                 Deletes the created stack or prints an error message
+----------------------------------------------------------------------------*/
+void delete_SegStack (SegStack ** spp)
+{
+    SegChunk * chunk = 0;   /* chunk being deallocated */
+
+    /* If statement is executed if spp or the stack it points to does not
+     * exist */
+    if (!spp || !*spp)
+    {
+        writeline (DELETE_NONEXIST, stderr);   /* error message printed */
+        return;
+    }
+
+    while ( (chunk = (*spp)->chunk) )
+    {
+        (*spp)->chunk = chunk->below;
+        free (chunk);
+    }
+
+    free ((*spp)->spare);
+    free (*spp);
+    *spp = NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          empty_SegStack
+Purpose:                This function empties a segmented stack
+Description:            This function steps down to the bottom chunk, keeping
+                        the first chunk it leaves as the spare if there is
+                        none yet and freeing the others, then marks the
+                        bottom chunk empty
+Input:                  this_Stack: the stack which will be emptied
+Result:                 Empties the items in the stack or prints an error
+                        message
+----------------------------------------------------------------------------*/
+void empty_SegStack (SegStack * this_Stack)
+{
+    SegChunk * chunk = 0;   /* chunk being left */
+
+    /* If statement is executed when stack has not been set yet */
+    if (!this_Stack)
+    {
+        writeline (EMPTY_NONEXIST, stderr);     /* error message printed */
+        return;
+    }
+
+    while ( this_Stack->chunk->below )
+    {
+        chunk = this_Stack->chunk;
+        this_Stack->chunk = chunk->below;
+
+        if (this_Stack->spare)
+        {
+            free (chunk);
+        }
+        else
+        {
+            this_Stack->spare = chunk;
+        }
+    }
+
+    this_Stack->used = 0;
+    this_Stack->count = 0;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          isempty_SegStack
+Purpose:                This function checks to see if the stack is empty
+Description:            This function compares the number of elements on the
+                        stack to 0
+Input:                  this_Stack: the stack being checked
+Result:                 True if the stack is empty, false if it is not, and
+                        true with an error message if the stack does not exist
+----------------------------------------------------------------------------*/
+long isempty_SegStack (SegStack * this_Stack)
+{
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (ISEMPTY_NONEXIST, stderr);      /* error message printed */
+        return 1;
+    }
+
+    return this_Stack->count == 0;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          new_SegStack
+Purpose:                This function allocates a segmented stack whose chunks
+                        hold chunksize longs
+Description:            This function allocates the stack and its bottom
+                        chunk, so that pushing onto a new stack does not
+                        allocate. A chunksize of 0 picks SEG_CHUNK
+Input:                  chunksize: number of longs in every chunk
+Result:                 A pointer to the new stack, or NULL if the size is
+                        too large or memory could not be allocated and an
+                        error message is printed
+----------------------------------------------------------------------------*/
+SegStack * new_SegStack (unsigned long chunksize)
+{
+    SegStack * this_Stack = 0;  /* the stack being created */
+
+    /* If statement is executed if no chunk size was asked for */
+    if (!chunksize)
+    {
+        chunksize = SEG_CHUNK;
+    }
+
+    this_Stack = malloc (sizeof(SegStack));
+
+    /* If statement is executed if the stack could not be allocated */
+    if (!this_Stack)
+    {
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    this_Stack->chunk = new_chunk (chunksize);
+
+    /* If statement is executed if the bottom chunk could not be allocated */
+    if (!this_Stack->chunk)
+    {
+        free (this_Stack);
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    this_Stack->spare = NULL;
+    this_Stack->used = 0;
+    this_Stack->size = chunksize;
+    this_Stack->count = 0;
+
+    return this_Stack;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          num_elements_SegStack
+Purpose:                This function returns the number of elements in stack
+Description:            This function returns the count the stack keeps over
+                        all of its chunks
+Input:                  this_Stack: the stack we used to check the number of
+                        elements in
+Result:                 The number of elements if the stack has been set.
+                        False if not and an error message is printed
+----------------------------------------------------------------------------*/
+long num_elements_SegStack (SegStack * this_Stack)
+{
+    /* If statement is executed if the stack has not been set yet */
+    if (!this_Stack)
+    {
+        writeline (NUM_NONEXIST, stderr);     /* error message printed */
+        return 0;
+    }
+
+    return this_Stack->count;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          pop_SegStack
+Purpose:                This function removes the top item in stack
+Description:            This function checks to see if stack has been set yet
+                        or if it is empty. If so, an error message is printed.
+                        If not, the top item is taken from the top chunk. A
+                        chunk left empty, other than the bottom one, becomes
+                        the spare, freeing any older spare, and the chunk
+                        below becomes the top chunk
+Input:                  this_Stack: the stack from which we are getting our
+                                    items
+                        item: the number we will remove from the stack
+Result:                 True if the removal of the top item was a success.
+                        False if the stack has yet to be made or is empty
+                        and an error message is printed
+----------------------------------------------------------------------------*/
+long pop_SegStack (SegStack * this_Stack, long * item)
+{
+    SegChunk * chunk = 0;   /* the top chunk */
+
+    /* If statement is executed when the stack has not been set yet */
+    if (!this_Stack)
+    {
+        writeline (POP_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed when the buffer has not been set yet */
+    if (!item)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed when the stack is already empty */
+    if (this_Stack->count == 0)
+    {
+        writeline (POP_EMPTY, stderr);  /* error message printed */
+        return 0;
+    }
+
+    chunk = this_Stack->chunk;
+    *item = chunk->values[--this_Stack->used];
+    this_Stack->count--;
+
+    /* If statement is executed when the pop emptied a chunk above the
+     * bottom one */
+    if (this_Stack->used == 0 && chunk->below)
+    {
+        free (this_Stack->spare);
+        this_Stack->spare = chunk;
+        this_Stack->chunk = chunk->below;
+        this_Stack->used = this_Stack->size;
+    }
+
+    return 1;
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          push_SegStack
+Purpose:                This function adds a new element to the top of stack
+Description:            This function first checks for EOF, as push does, then
+                        checks to see if stack is set yet. If the top chunk is
+                        full, the spare chunk, or a newly allocated one when
+                        there is no spare, is linked above it. The item is
+                        then stored in the top chunk. No element already on
+                        the stack is ever moved
+Input:                  this_Stack: the stack in question
+                        item: the long being stored to the top of stack
+Result:                 True if the push can be made, an error message prints
+                        if a chunk could not be allocated or stack does not
+                        exist yet, and EOF for our ^D test
+-----------------------------------------------------------------------------*/
+long push_SegStack (SegStack * this_Stack, long item)
+{
+    SegChunk * chunk = 0;   /* chunk linked above the top */
+
+    /* If statement is executed when EOF is reached */
+    if (item == EOF)
+    {
+        return EOF;
+    }
+
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (PUSH_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the top chunk is full */
+    if (this_Stack->used == this_Stack->size)
+    {
+        chunk = this_Stack->spare;
+        this_Stack->spare = NULL;
+
+        if (!chunk && !(chunk = new_chunk (this_Stack->size)) )
+        {
+            writeline (PUSH_FULL, stderr);     /* error message printed */
+            return 0;
+        }
+
+        chunk->below = this_Stack->chunk;
+        this_Stack->chunk = chunk;
+        this_Stack->used = 0;
+    }
+
+    this_Stack->chunk->values[this_Stack->used++] = item;
+    this_Stack->count++;
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          top_SegStack
+Purpose:                This function sends back the top element in the stack
+Description:            This function first checks to see if the stack has
+                        been set yet or if it is already empty. If so, an
+                        error message is printed. If not, the last element of
+                        the top chunk is sent back
+Input:                  this_Stack: the stack from which we are getting our
+                                    items
+                        item: the number on top of the stack
+Result:                 True if there is a top item in the stack. False if
+                        the stack has yet to be set or is already empty and
+                        an error message is printed
+----------------------------------------------------------------------------*/
+long top_SegStack (SegStack * this_Stack, long * item)
+{
+    /* If statement is executed when the stack has not been set yet */
+    if (!this_Stack)
+    {
+        writeline (TOP_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed when the buffer has not been set yet */
+    if (!item)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed when the stack is already empty */
+    if (this_Stack->count == 0)
+    {
+        writeline (TOP_EMPTY, stderr);    /* error message printed */
+        return 0;
+    }
+
+    *item = this_Stack->chunk->values[this_Stack->used - 1];
+
+    return 1;
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          new_chunk
+Purpose:                This function allocates one chunk of a segmented stack
+Description:            This function allocates the link and size longs in
+                        one block, refusing sizes that overflow it, and
+                        starts the chunk linked to nothing
+Input:                  size: number of longs the chunk holds
+Result:                 The new chunk, or NULL if it could not be allocated
+-----------------------------------------------------------------------------*/
+static SegChunk * new_chunk (unsigned long size)
+{
+    SegChunk * chunk = 0;   /* the chunk allocated */
+
+    /* If statement is executed if the size overflows the allocation */
+    if (size > ((size_t)-1 - sizeof(SegChunk)) / sizeof(long))
+    {
+        return NULL;
+    }
+
+    chunk = malloc (sizeof(SegChunk) + size * sizeof(long));
+
+    /* If statement is executed if the chunk was allocated */
+    if (chunk)
+    {
+        chunk->below = NULL;
+    }
+
+    return chunk;
+}
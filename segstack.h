@@ -0,0 +1,39 @@
+#ifndef SEGSTACK_H
+#define SEGSTACK_H
+
+/* This segmented implementation of stack keeps its longs in fixed-size
+chunks linked from the top chunk down, instead of in one array, so it has
+no size limit and growing it never moves the elements already pushed.  A
+push that fills the top chunk links a new one above it and a pop that
+empties a chunk steps back to the one below.  The chunk just left is kept
+as a spare rather than freed, so pushes and pops going back and forth over
+a chunk edge do not call malloc and free every time. */
+
+typedef struct SegStack SegStack;
+
+void delete_SegStack (SegStack **); /* deallocates the stack and every
+                                   chunk.  Assigns incoming pointer to
+                                   NULL. */
+void empty_SegStack (SegStack *); /* empties the stack, freeing every chunk
+                                   but the bottom one and the spare */
+long isempty_SegStack (SegStack *); /* returns 0 or non-0 value indicating
+                                   whether or not the stack is empty */
+SegStack * new_SegStack (unsigned long); /* allocates the stack with chunks
+                                   of the given number of longs, 0 choosing
+                                   a default.  Result is the new stack, or
+                                   NULL if memory could not be allocated */
+long num_elements_SegStack (SegStack *); /* returns the number of elements
+                                   stored on the stack */
+long pop_SegStack (SegStack *, long *); /* removes and sends back the top
+                                   element of the stack.  Result is 0 or
+                                   non-0, indicating failure or success,
+                                   respectively */
+long push_SegStack (SegStack *, long); /* places one value on the stack.
+                                   Result is 0 or non-0 indicating failure
+                                   or success, respectively */
+long top_SegStack (SegStack *, long *); /* sends back the top element of the
+                                   stack.  Stack is left unaffected.  Result
+                                   is 0 or non-0 indicating failure or
+                                   success, respectively. */
+
+#endif
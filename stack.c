@@ -12,30 +12,132 @@ Description:    This program implements an array-based stack of longs that can
 ******************************************************************************/
 
 #include <malloc.h>
+#include <stdatomic.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 #include "mylib.h"
 #include "stack.h"
+#include "stats.h"
+#include "trace.h"
 
-#define STACK_POINTER_INDEX (-1)        /* Index of last used space */
-#define STACK_SIZE_INDEX (-2)           /* Index of size of the stack */
-#define STACK_COUNT_INDEX (-3)          /* Index of which stack allocated */
-#define STACK_OFFSET 3  /* offset from allocation to where user info begins */
+#define STACK_GROWTH 2  /* factor by which growable stacks expand when full */
+
+#define WRITE_BUFFER 4096   /* bytes of text write_Stack writes at once */
+
+#define LOAD_CHUNK 4096     /* longs load_Stack reads before it grows */
+
+#define DUMP_MAGIC 0x31504D444B545343L  /* "CSTKDMP1" in a dump file */
+#define DUMP_VERSION 1          /* version of the dump layout */
+#define DUMP_CHECKSUM 1         /* flag set when the dump has a checksum */
+#define DUMP_PRIME 0x100000001B3UL  /* FNV prime mixed into the checksum */
+#define DUMP_SEED 0xCBF29CE484222325UL  /* FNV offset the checksum starts at */
+
+/* The header of a dump, written before the elements of the stack, which
+ * follow as one raw block of longs. */
+typedef struct DumpHeader 
+{
+    long magic;             /* DUMP_MAGIC */
+    long version;           /* DUMP_VERSION */
+    long width;             /* bytes in a long */
+    long flags;             /* DUMP_CHECKSUM or 0 */
+    long size;              /* size of the stack */
+    long count;             /* number of elements in the dump */
+    unsigned long checksum; /* checksum of the elements, if flagged */
+} DumpHeader;
+
+#define CACHE_LINE 64       /* bytes in a cache line */
+#define HUGE_PAGE (1UL << 21)   /* bytes in a huge page */
+
+/* Longs before the user data of a placed block: the header and the three
+ * placement longs below it, rounded up to whole cache lines. */
+#define PLACED_PAD \
+    ( (STACK_OFFSET + 3 + CACHE_LINE / sizeof(long) - 1) \
+      / (CACHE_LINE / sizeof(long)) * (CACHE_LINE / sizeof(long)) )
+#define PLACED_LENGTH 0     /* Index in a placed block of its bytes */
+#define PLACED_OPTIONS 1    /* Index in a placed block of its options */
+#define PLACED_NODE 2       /* Index in a placed block of its NUMA node */
+
+/* start of the block behind a placed stack */
+#define PLACED_BASE(this_Stack) ( (this_Stack) - PLACED_PAD )
+
+/* whether a placed block was mapped rather than allocated */
+#define PLACED_MAPPED(options, node) \
+    ( ((options) & STACK_HUGE_PAGES) || (node) >= 0 )
+
+#define NODE_WORDS 16       /* longs in the node mask given to mbind */
+#define PREFER_NODE 1       /* MPOL_PREFERRED policy of mbind */
+
+#define STAMP_BATCH 1024    /* mark stamps a thread takes at a time */
+#define MARKS_ROOM 4        /* older epochs first kept room for */
+
+/* The marks of a stack, kept beside it from its first mark_Stack.  A mark
+ * is a stamp from a counter shared by every stack, so it names one epoch
+ * of one stack, and every mark of an epoch is taken at the same depth.
+ * The newest epoch is kept alone, and older epochs whose marks are still
+ * good follow with rising depths, the oldest first. */
+typedef struct MarkEpoch 
+{
+    long stamp;             /* mark of the epoch */
+    long depth;             /* elements when its marks were taken */
+} MarkEpoch;
+
+typedef struct MarkTable 
+{
+    long stamp;             /* mark of the newest epoch, 0 before any */
+    long depth;             /* elements when its marks were taken */
+    long count;             /* older epochs kept */
+    long room;              /* older epochs there is room for */
+    MarkEpoch older[];      /* the older epochs, the oldest first */
+} MarkTable;
+
+/* the marks of a stack, or NULL if it has never been marked */
+#define MARKS_OF(this_Stack) ( (MarkTable *)(this_Stack)[STACK_MARKS_INDEX] )
+
+#define POOL_MIN_CLASS 3    /* smallest pooled block is 1 << 3 longs */
+#define POOL_MAX_CLASS 20   /* largest pooled block is 1 << 20 longs */
+#define POOL_DEPTH 64       /* most free blocks kept in each size class */
 
 /* catastrophic error messages */
+static const char ALLOCATE_FAILED[] = "Allocating a stack failed!!!\n";
+static const char DELETE_MAPPED[] = "Deleting a file-backed stack!!!\n";
 static const char DELETE_NONEXIST[] = "Deleting a non-existent stack!!!\n";
+static const char DETACH_NONEXIST[] = "Detaching a non-existent stack!!!\n";
+static const char DUMP_FAILED[] = "Dumping a stack failed!!!\n";
+static const char DUMP_NONEXIST[] = "Dumping a non-existent stack!!!\n";
 static const char EMPTY_NONEXIST[] = "Emptying a non-existent stack!!!\n";
+static const char GROW_FAILED[] = "Growing a stack failed!!!\n";
+static const char GROW_MAPPED[] = "Resizing a file-backed stack!!!\n";
+static const char GROW_NONEXIST[] = "Growing a non-existent stack!!!\n";
 static const char INCOMING_NONEXIST[] = 
                         "Incoming parameter does not exist!!!\n";
 static const char ISEMPTY_NONEXIST[] = 
                         "Isempty check from a non-existent stack!!!\n";
 static const char ISFULL_NONEXIST[] = 
                         "Isfull check from a non-existent stack!!!\n";
+static const char LOAD_CORRUPT[] = "Loading a corrupt stack dump!!!\n";
+static const char LOAD_NONEXIST[] = 
+                        "Loading from a non-existent file pointer!!!\n";
+static const char MARK_FAILED[] = "Marking a stack failed!!!\n";
+static const char MARK_NONEXIST[] = "Marking a non-existent stack!!!\n";
 static const char NUM_NONEXIST[] = 
                         "Num_elements check from a non-existent stack!!!\n";
 static const char POP_NONEXIST[] = "Popping from a non-existent stack!!!\n";
 static const char POP_EMPTY[] = "Popping from an empty stack!!!\n"; 
 static const char PUSH_NONEXIST[] = "Pushing to a non-existent stack!!!\n";
 static const char PUSH_FULL[] = "Pushing to a full stack!!!\n";
+static const char RENUMBER_NONEXIST[] = 
+                        "Renumbering a non-existent stack!!!\n";
+static const char RESERVED_NONEXIST[] = 
+                        "Reserved check from a non-existent stack!!!\n";
+static const char ROLLBACK_NONEXIST[] = 
+                        "Rolling back a non-existent stack!!!\n";
+static const char ROLLBACK_STALE[] = 
+                        "Rolling back to a stale or foreign mark!!!\n";
+static const char SHRINK_NONEXIST[] = "Shrinking a non-existent stack!!!\n";
 static const char TOP_NONEXIST[] = "Topping from a non-existent stack!!!\n";
 static const char TOP_EMPTY[] = "Topping from an empty stack!!!\n";
 static const char WRITE_NONEXIST_FILE[] = 
@@ -43,30 +145,127 @@ static const char WRITE_NONEXIST_FILE[] =
 static const char WRITE_NONEXIST_STACK[] = 
                         "Attempt to write to a non-existent stack!!!\n";
 
-/* Debug messages. HEX messages used for negative numbers on the stack. */
-static const char ALLOCATED[] = "[Stack %ld has been allocated]\n";
-static const char DEALLOCATE[] = "[Stack %ld has been deallocated]\n";
-static const char HEXPOP[] = "[Stack %ld - Popping 0x%lx]\n";
-static const char HEXPUSH[] = "[Stack %ld - Pushing 0x%lx]\n";
-static const char HEXTOP[] = "[Stack %ld - Topping 0x%lx]\n";
-static const char POP[] = "[Stack %ld - Popping %ld]\n";
-static const char PUSH[] = "[Stack %ld - Pushing %ld]\n";
-static const char TOP[] = "[Stack %ld - Topping %ld]\n";
-
 /* static variable allocation */
-static int debug = FALSE; /* allocation of debug flag */
-static int stack_counter = 0; /* number of stacks allocated so far */
-
-/* Debug state methods */
+static int secure = FALSE; /* allocation of secure clearing flag */
+static _Atomic long stack_counter = 0; /* number of stacks allocated now */
+static _Atomic long stack_serial = 0; /* last stack number handed out */
+static _Atomic long mark_stamp = 0; /* last batch of mark stamps given out */
+static _Thread_local long stamp_next = 0; /* next stamp of this thread */
+static _Thread_local long stamp_end = 0; /* first stamp past its batch */
+
+/* allocator used for the memory behind every stack */
+static void * (*allocate) (size_t) = malloc;
+static void * (*reallocate) (void *, size_t) = realloc;
+static void (*release) (void *) = free;
+
+/* Stack pool.  Blocks of 1 << class longs, header included, are kept on a
+ * free list per size class when their stack is deleted and handed out again
+ * by new_Stack.  The first long of a free block links to the next one.  The
+ * pool is per thread so that no locking is needed. */
+static int pool = FALSE; /* allocation of pool flag */
+static _Thread_local void * pool_list[POOL_MAX_CLASS + 1]; /* free blocks */
+static _Thread_local long pool_count[POOL_MAX_CLASS + 1]; /* blocks in lists */
+
+static unsigned long checksum_Stack (Stack * this_Stack, long count);
+static Stack * get_block (unsigned long stacksize);
+static Stack * get_placed (unsigned long stacksize, long options, long node);
+static MarkTable * grow_marks (Stack * this_Stack);
+static void * map_placed (unsigned long * length, long options, long node);
+static long new_stamp (void);
+static void put_block (Stack * this_Stack);
+static long resize_Stack (Stack ** spp, unsigned long stacksize);
+static long size_class (unsigned long stacksize);
+static Stack * start_Stack (Stack * this_Stack, unsigned long stacksize);
+
+/* Debug state methods, debug messages are recorded by the stack trace */
 void debug_off (void) 
 {
-        debug = FALSE;
+        trace_off ();
 }
 
 
 void debug_on (void) 
 {
-        debug = TRUE;
+        trace_on ();
+}
+
+
+/* Secure clearing state methods */
+void secure_off (void) 
+{
+        secure = FALSE;
+}
+
+
+void secure_on (void) 
+{
+        secure = TRUE;
+}
+
+
+/* Stack pool state methods */
+void pool_off (void) 
+{
+        pool = FALSE;
+}
+
+
+void pool_on (void) 
+{
+        pool = TRUE;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          pool_trim
+Purpose:                This function gives the calling thread's pooled blocks
+                        back to the allocator
+Description:            This function walks the free list of every size class
+                        and releases each block, leaving the lists empty.
+                        Stacks that are still allocated are not affected
+Input:                  None
+Result:                 The calling thread's pool holds no blocks
+----------------------------------------------------------------------------*/
+void pool_trim (void) 
+{
+    long class = 0;         /* size class being trimmed */
+    void * block = 0;       /* free block being released */
+
+    for (class = POOL_MIN_CLASS; class <= POOL_MAX_CLASS; class++)
+    {
+        while ( (block = pool_list[class]) )
+        {
+            pool_list[class] = *(void **)block;
+            release (block);
+        }
+
+        pool_count[class] = 0;
+    }
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          set_allocator_Stack
+Purpose:                This function chooses the allocator used for the
+                        memory behind every stack
+Description:            This function replaces the allocate, reallocate and
+                        release functions. Passing NULL for any of them puts
+                        back malloc, realloc and free. The allocator should
+                        only be changed while no stacks are allocated and
+                        the pool is empty, since memory must be given back
+                        to the allocator it came from
+Input:                  new_allocate: replacement for malloc
+                        new_reallocate: replacement for realloc
+                        new_release: replacement for free
+Result:                 Later stacks use the given allocator
+----------------------------------------------------------------------------*/
+void set_allocator_Stack (void * (*new_allocate) (size_t),
+                          void * (*new_reallocate) (void *, size_t),
+                          void (*new_release) (void *)) 
+{
+    allocate = new_allocate ? new_allocate : malloc;
+    reallocate = new_reallocate ? new_reallocate : realloc;
+    release = new_release ? new_release : free;
 }
 
 
@@ -77,7 +276,8 @@ Description:            This function checks to see if the stack has not
                         been set yet or if the pointer to the stack has not
                         yet been set yet. If so, an error message is printed.
                         If not, we then deallocate the memory to free the
-                        stack
+                        stack, keeping it in the pool for reuse when it
+                        came from there
 Input:                  spp: the stack from which we will deallocate memory
 Result:                 Deletes the created stack or prints an error message
 ----------------------------------------------------------------------------*/
@@ -91,17 +291,107 @@ void delete_Stack (Stack ** spp)
         return;
     }
 
+    /* If statement is executed if the stack lives in a file, which only
+     * close_PStack may unmap */
+    if ( (*spp)[STACK_BLOCK_INDEX] == STACK_MAPPED )
+    {
+        writeline (DELETE_MAPPED, stderr);     /* error message printed */
+        return;
+    }
+
     /* If statement is executed if debug mode is on */
-    if (debug)
+    if (TRACING)
     {
-        fprintf (stderr, DEALLOCATE, (long)stack_counter);
+        trace_record (TRACE_DEALLOCATE, (*spp)[STACK_COUNT_INDEX], 0);
     }
 
     /* code to deallocate the memory, set the pointer being pointed to NULL,
      * and decrement stack_counter */
-    free (*spp - STACK_OFFSET);
+    detach_Stack (*spp);
+    put_block (*spp);
     *spp = NULL;
-    stack_counter--;
+    atomic_fetch_sub_explicit (&stack_counter, 1, memory_order_relaxed);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          detach_Stack
+Purpose:                This function frees what is kept beside a stack
+Description:            This function frees the marks of a stack that has
+                        been marked and the counters of a watched stack
+                        (stats.h), clearing the header slots pointing to
+                        them, so that every earlier mark is refused. The
+                        stack and its elements are left as they are
+Input:                  this_Stack: the stack in question
+Result:                 The memory beside the stack is freed, or an error
+                        message is printed if the stack does not exist
+----------------------------------------------------------------------------*/
+void detach_Stack (Stack * this_Stack) 
+{
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (DETACH_NONEXIST, stderr);   /* error message printed */
+        return;
+    }
+
+    free ( MARKS_OF (this_Stack) );
+    this_Stack[STACK_MARKS_INDEX] = 0;
+    STATS_RELEASE (this_Stack);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          dump_Stack
+Purpose:                This function saves a stack in binary form
+Description:            This function writes a versioned header, holding the
+                        size of the stack, its number of elements and, when
+                        asked for, a checksum of them, and then writes the
+                        elements straight from the stack array with a single
+                        fwrite. Such a dump is read back with load_Stack
+Input:                  this_Stack: the stack being saved
+                        stream: the file the dump is written to
+                        checksum: non-0 to include a checksum of the elements
+Result:                 True if the dump was written. False if the stack or
+                        file does not exist or the write failed and an error
+                        message is printed
+----------------------------------------------------------------------------*/
+long dump_Stack (Stack * this_Stack, FILE * stream, long checksum) 
+{
+    DumpHeader header;      /* header written before the elements */
+
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (DUMP_NONEXIST, stderr);     /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the file is not yet set */
+    if (!stream)
+    {
+        writeline (WRITE_NONEXIST_FILE, stderr);   /* error message printed */
+        return 0;
+    }
+
+    header.magic = DUMP_MAGIC;
+    header.version = DUMP_VERSION;
+    header.width = sizeof(long);
+    header.flags = checksum ? DUMP_CHECKSUM : 0;
+    header.size = this_Stack[STACK_SIZE_INDEX];
+    header.count = this_Stack[STACK_POINTER_INDEX] + 1;
+    header.checksum = checksum ? checksum_Stack (this_Stack, header.count) : 0;
+
+    /* If statement is executed if the header or elements were not written */
+    if ( fwrite (&header, sizeof(header), 1, stream) != 1 ||
+         fwrite (this_Stack, sizeof(long), header.count, stream) 
+         != (size_t)header.count )
+    {
+        writeline (DUMP_FAILED, stderr);       /* error message printed */
+        return 0;
+    }
+
+    return 1;
 }
 
 
@@ -111,17 +401,16 @@ Purpose:                This function empties a stack
 Description:            This function check to see if the stack has been set
                         yet. If not, an error message is printed and the 
                         function ends. If the stack has been set, then the
-                        while loop loops through all of the indexes of the 
-                        stack, deleting every value until it reaches its 
-                        initial index
+                        stack pointer is moved back to its initial index in
+                        constant time. The old values are left in place
+                        unless secure clearing is on, in which case the used
+                        part of the stack is overwritten with zeroes first
 Input:                  this_Stack: the stack which will be emptied
 Result:                 Empties the items in the stack or prints an error 
                         message
 ----------------------------------------------------------------------------*/
 void empty_Stack (Stack * this_Stack) 
 {
-    long pointerIndex = 0;  /* variable for original index of pointer index */
-
     /* If statement is executed when stack has not been set yet */
     if (!this_Stack)
     {
@@ -129,15 +418,15 @@ void empty_Stack (Stack * this_Stack)
         return;
     }
 
-    /* While loop loops through all of the indexes in stack */
-    while (this_Stack[STACK_POINTER_INDEX] != -1)
+    /* If statement is executed when secure clearing is on */
+    if (secure)
     {
-        /* code used to remove item from the top of stack and to move to the
-         * next index in the stack */ 
-        pointerIndex = this_Stack[STACK_POINTER_INDEX];
-        this_Stack[pointerIndex] = 0;
-        this_Stack[STACK_POINTER_INDEX]--;
+        memset (this_Stack, 0, 
+                (this_Stack[STACK_POINTER_INDEX] + 1) * sizeof(long));
     }
+
+    this_Stack[STACK_POINTER_INDEX] = -1;   /* reset to the initial index */
+    this_Stack[STACK_LOW_INDEX] = 0;        /* every mark above is stale */
 }
 
 
@@ -205,51 +494,269 @@ long isfull_Stack (Stack * this_Stack)
 }
 
 
+/*----------------------------------------------------------------------------
+Function Name:          load_Stack
+Purpose:                This function restores a stack saved by dump_Stack
+Description:            This function reads and checks the dump header, then
+                        reads the elements straight into the stack array,
+                        growing it geometrically from LOAD_CHUNK longs as
+                        they arrive, so the memory taken follows what the
+                        file holds rather than the counts in its header.
+                        When the dump has a checksum it is compared against
+                        the elements read, and only then is the stack grown
+                        to the saved size
+Input:                  stream: the file the dump is read from
+Result:                 A pointer to where user data begins in the new stack.
+                        NULL if the file does not exist, the dump is short or
+                        corrupt, or memory could not be allocated and an
+                        error message is printed
+----------------------------------------------------------------------------*/
+Stack * load_Stack (FILE * stream) 
+{
+    DumpHeader header;      /* header read before the elements */
+    Stack * this_Stack = 0; /* the restored stack */
+    long loaded = 0;        /* elements read so far */
+    long wanted = 0;        /* elements the next read asks for */
+    size_t got = 0;         /* elements the last read gave */
+
+    /* If statement is executed if the file is not yet set */
+    if (!stream)
+    {
+        writeline (LOAD_NONEXIST, stderr);     /* error message printed */
+        return NULL;
+    }
+
+    /* If statement is executed if the header is missing or does not match
+     * this layout */
+    if ( fread (&header, sizeof(header), 1, stream) != 1 ||
+         header.magic != DUMP_MAGIC || header.version != DUMP_VERSION ||
+         header.width != sizeof(long) || header.count < 0 ||
+         header.count > header.size )
+    {
+        writeline (LOAD_CORRUPT, stderr);      /* error message printed */
+        return NULL;
+    }
+
+    this_Stack = new_Stack (header.count < LOAD_CHUNK ? header.count :
+                                                        LOAD_CHUNK);
+
+    /* If statement is executed if memory could not be allocated */
+    if (!this_Stack)
+    {
+        return NULL;
+    }
+
+    for (loaded = 0; loaded < header.count; loaded += got)
+    {
+        /* If statement is executed if the stack is full, when it grows by
+         * STACK_GROWTH but no further than the dump's elements */
+        if ( loaded == this_Stack[STACK_SIZE_INDEX] &&
+             !resize_Stack (&this_Stack, 
+                            header.count / STACK_GROWTH < loaded ? 
+                            header.count : loaded * STACK_GROWTH) )
+        {
+            delete_Stack (&this_Stack);
+            return NULL;
+        }
+
+        wanted = this_Stack[STACK_SIZE_INDEX] < header.count ?
+                 this_Stack[STACK_SIZE_INDEX] - loaded : 
+                 header.count - loaded;
+        got = fread (this_Stack + loaded, sizeof(long), wanted, stream);
+        this_Stack[STACK_POINTER_INDEX] += got;
+
+        /* If statement is executed if the file ended early */
+        if (!got)
+        {
+            break;
+        }
+    }
+
+    /* If statement is executed if the elements are short or do not match
+     * the checksum */
+    if ( loaded != header.count ||
+         ( (header.flags & DUMP_CHECKSUM) &&
+           checksum_Stack (this_Stack, header.count) != header.checksum ) )
+    {
+        writeline (LOAD_CORRUPT, stderr);      /* error message printed */
+        delete_Stack (&this_Stack);
+        return NULL;
+    }
+
+    /* If statement is executed if the saved size could not be reserved */
+    if ( !resize_Stack (&this_Stack, header.size) )
+    {
+        delete_Stack (&this_Stack);
+        return NULL;
+    }
+
+    return this_Stack;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          mark_Stack
+Purpose:                This function marks the current depth of the stack
+Description:            This function gives the mark of the newest epoch
+                        again if it was taken at this depth and the stack
+                        has held no fewer elements since. Otherwise a new
+                        epoch is started with a new stamp as its mark. The
+                        epoch it ends is kept if its marks are still good,
+                        and older epochs the stack has since held fewer
+                        elements than are forgotten, so the marks kept
+                        never outnumber the elements. The marks are kept
+                        beside the stack, made on the first mark_Stack,
+                        which on an inline stack is the one heap allocation
+                        it makes
+Input:                  this_Stack: the stack being marked
+Result:                 The mark, always positive. -1 if the stack does not
+                        exist or its marks could not be allocated and an
+                        error message is printed
+----------------------------------------------------------------------------*/
+long mark_Stack (Stack * this_Stack) 
+{
+    MarkTable * marks = 0;  /* the marks of the stack */
+    long depth = 0;         /* elements on the stack */
+    long low = 0;           /* fewest elements held since the newest mark */
+
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (MARK_NONEXIST, stderr);     /* error message printed */
+        return -1;
+    }
+
+    marks = MARKS_OF (this_Stack);
+    depth = this_Stack[STACK_POINTER_INDEX] + 1;
+    low = this_Stack[STACK_LOW_INDEX];
+
+    /* If statement is executed if the newest mark was taken at this depth
+     * and is still good, when it is given again */
+    if (marks && marks->stamp && marks->depth == depth && low == depth)
+    {
+        return marks->stamp;
+    }
+
+    /* If statement is executed if the stack has never been marked */
+    if ( !marks && !(marks = grow_marks (this_Stack)) )
+    {
+        writeline (MARK_FAILED, stderr);       /* error message printed */
+        return -1;
+    }
+
+    /* older epochs whose depth the stack has since gone below are stale */
+    while (marks->count && marks->older[marks->count - 1].depth > low)
+    {
+        marks->count--;
+    }
+
+    /* If statement is executed if the marks of the newest epoch are still
+     * good, when it is kept with the older ones */
+    if (marks->stamp && marks->depth == low)
+    {
+        /* If statement is executed if there is no room to keep it */
+        if ( marks->count == marks->room && 
+             !(marks = grow_marks (this_Stack)) )
+        {
+            writeline (MARK_FAILED, stderr);   /* error message printed */
+            return -1;
+        }
+
+        marks->older[marks->count].stamp = marks->stamp;
+        marks->older[marks->count].depth = marks->depth;
+        marks->count++;
+    }
+
+    marks->stamp = new_stamp ();
+    marks->depth = depth;
+    this_Stack[STACK_LOW_INDEX] = depth;
+
+    return marks->stamp;
+}
+
+
 /*-----------------------------------------------------------------------------
 Function Name:          new_Stack
 Purpose:                This function allocates memory to hold stacksize number
                         of longs, initializes the stack infrastructure, and
                         returns a pointer to the first storage space in the
                         stack
-Description:            This function creates a pointer which takes the number 
-                        of elements you want to hold and multiplies it by the 
-                        size of long. A second pointer is then created because
-                        of the offset where our previous pointer is added to
-                        STACK_OFFSET. We then initialize the elements
-                        corresponding to our stack and increment its counter to
-                        track how many Stack data structures are allocated
+Description:            This function obtains a block able to hold the number
+                        of elements you want plus STACK_OFFSET header longs,
+                        from the pool when it is on or from the allocator
+                        otherwise, and points past the header to where user
+                        data begins. We then initialize the elements
+                        corresponding to our stack, give it the next stack
+                        number and increment the counter that tracks how
+                        many Stack data structures are allocated
 Input:                  stacksize: number of longs allocated into memory
 Result:                 A pointer that points to the address of the array where
-                        user data allotment begins
+                        user data allotment begins, or NULL if memory could
+                        not be allocated and an error message is printed
 -----------------------------------------------------------------------------*/
 Stack * new_Stack (unsigned long stacksize) 
 {
-    /* void pointer used to allocate memory for the stack using the formula */
-    void * memory = malloc ( (stacksize + STACK_OFFSET) * sizeof(long) );
-
-    /* Stack pointer used for returning in function because of offset  */
-    Stack * this_Stack = (Stack *)memory + STACK_OFFSET;
+    return start_Stack (get_block (stacksize), stacksize);
+}
 
-    /* new stack starts at an index of -1  */
-    this_Stack[STACK_POINTER_INDEX] = -1;
 
-    /* stores the size of stack  */
-    this_Stack[STACK_SIZE_INDEX] = stacksize;
+/*-----------------------------------------------------------------------------
+Function Name:          new_inline_Stack
+Purpose:                This function sets up a stack in memory the caller
+                        owns, usually a STACK_BUFFER
+Description:            This function points past the header at the start of
+                        the storage and sets the stack up as new_Stack does,
+                        marking the block as inline so that it is never
+                        freed. A growable function that finds the stack full
+                        moves it to a block from the pool or the allocator,
+                        and from then on it is an ordinary stack
+Input:                  storage: STACK_OFFSET + stacksize longs
+                        stacksize: number of longs the storage holds past
+                                   the header
+Result:                 A pointer that points to the address of the array where
+                        user data allotment begins, or NULL if the storage
+                        does not exist and an error message is printed
+-----------------------------------------------------------------------------*/
+Stack * new_inline_Stack (long * storage, unsigned long stacksize) 
+{
+    /* If statement is executed if the storage is not yet set */
+    if (!storage)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return NULL;
+    }
 
-    /* increases the counter of stack */
-    this_Stack[STACK_COUNT_INDEX]++;
+    storage[STACK_OFFSET + STACK_BLOCK_INDEX] = STACK_INLINE;
 
-    /* incrementation of stack counter to keep track of how many data 
-     * structures are allocated */
-    stack_counter++;
+    return start_Stack (storage + STACK_OFFSET, stacksize);
+}
 
-    /* If statement is executed when debug mode is on */
-    if (debug)
-    {
-        fprintf (stderr, ALLOCATED, this_Stack[STACK_COUNT_INDEX]);
-    }
 
-    return this_Stack;
+/*-----------------------------------------------------------------------------
+Function Name:          new_placed_Stack
+Purpose:                This function allocates a stack like new_Stack, with
+                        control over where its memory lies
+Description:            This function obtains a block whose user data begins
+                        on a cache line boundary, so the data is aligned for
+                        vector loads and the header shares no cache line
+                        with it. With STACK_HUGE_PAGES the block is mapped
+                        in huge pages when the system has them reserved, or
+                        else mapped with transparent huge pages asked for,
+                        which suits stacks of megabytes. A NUMA node other
+                        than STACK_ANY_NODE is asked for as the preferred
+                        node of the block's pages. The stack is then set up
+                        as new_Stack does. Placed stacks are never pooled,
+                        and keep their placement when resized
+Input:                  stacksize: number of longs allocated into memory
+                        options: 0 or STACK_HUGE_PAGES
+                        node: the preferred NUMA node, or STACK_ANY_NODE
+Result:                 A pointer that points to the address of the array where
+                        user data allotment begins, or NULL if memory could
+                        not be allocated and an error message is printed
+-----------------------------------------------------------------------------*/
+Stack * new_placed_Stack (unsigned long stacksize, long options, long node) 
+{
+    return start_Stack (get_placed (stacksize, options, node), stacksize);
 }
 
 
@@ -285,7 +792,8 @@ Purpose:                This function removes the top item in stack
 Description:            This function checks to see if stack has been set yet
                         or if it is empty. If so, an error message is printed.
                         If not, then we obtain the top item in the stack and
-                        remove it by making it equal to 0
+                        remove it by moving the stack pointer, making it equal
+                        to 0 as well when secure clearing is on
 Input:                  this_Stack: the stack from which we are getting our
                                     items
                         item: the number we will remove from the stack
@@ -301,28 +809,136 @@ long pop (Stack * this_Stack, long * item)
      * the stack is already empty */ 
     if (!this_Stack || this_Stack[STACK_POINTER_INDEX] <= -1)
     {
+        if (this_Stack)
+        {
+            STATS_ADD (this_Stack, STATS_POP_EMPTY, 1);
+        }
         writeline (POP_NONEXIST, stderr);  /* error message printed */
         return 0;
     }
 
     pointerIndex = this_Stack[STACK_POINTER_INDEX];
+    STATS_ADD (this_Stack, STATS_POPS, 1);
 
     /* If statement is executed when debug mode is on */
-    if (debug)
+    if (TRACING)
     {
-        fprintf (stderr, POP, (long)stack_counter, this_Stack[pointerIndex]);
+        trace_record (TRACE_POP, this_Stack[STACK_COUNT_INDEX],
+                      this_Stack[pointerIndex]);
     }
 
-    /* code used to obtain top item in stack, remove item, and reduce the 
-     * pointer index by one */
+    /* code used to obtain top item in stack and reduce the pointer index
+     * by one, the slot is only cleared when secure clearing is on */
     *item = this_Stack[pointerIndex];
-    this_Stack[pointerIndex] = 0;
+    if (secure)
+    {
+        this_Stack[pointerIndex] = 0;
+    }
     this_Stack[STACK_POINTER_INDEX]--;
 
+    /* If statement is executed if the stack holds fewer elements than it
+     * has since the newest mark, which makes marks above them stale */
+    if (pointerIndex < this_Stack[STACK_LOW_INDEX])
+    {
+        this_Stack[STACK_LOW_INDEX] = pointerIndex;
+    }
+
     return 1;    
 }
 
 
+/*----------------------------------------------------------------------------
+Function Name:          pop_n
+Purpose:                This function removes a block of items from the top of
+                        the stack in a single call
+Description:            This function validates the stack and the incoming
+                        buffer once, works out how many items can actually be
+                        removed, and moves them into the buffer with a single
+                        memcpy. The buffer receives the items in stack order,
+                        so the last item in the buffer is the old top of the
+                        stack and a pop_n followed by a push_n of the same
+                        buffer leaves the stack unchanged
+Input:                  this_Stack: the stack from which we are getting our
+                                    items
+                        items: the buffer receiving the removed items
+                        count: the number of items requested
+Result:                 The number of items removed, which is less than count
+                        when the stack holds fewer items. 0 if the stack or
+                        buffer does not exist or the stack is empty and an
+                        error message is printed
+----------------------------------------------------------------------------*/
+long pop_n (Stack * this_Stack, long * items, unsigned long count) 
+{
+    long available = 0;     /* number of items currently on the stack */
+    long index = 0;         /* index of the first item being removed */
+
+    /* If statement is executed when the stack has not been set yet */
+    if (!this_Stack)
+    {
+        writeline (POP_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed when the buffer has not been set yet */
+    if (!items)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    available = this_Stack[STACK_POINTER_INDEX] + 1;
+
+    /* If statement is executed when the stack is already empty */
+    if (available <= 0)
+    {
+        STATS_ADD (this_Stack, STATS_POP_EMPTY, 1);
+        writeline (POP_EMPTY, stderr);  /* error message printed */
+        return 0;
+    }
+
+    /* only remove as many items as the stack holds */
+    if (count > (unsigned long)available)
+    {
+        count = available;
+    }
+
+    index = available - count;
+
+    /* If statement is executed when debug mode is on, messages are
+     * printed in the same order a series of pops would print them */
+    if (TRACING)
+    {
+        long current = 0;   /* index of the item being reported */
+
+        for (current = available - 1; current >= index; current--)
+        {
+            trace_record (TRACE_POP, this_Stack[STACK_COUNT_INDEX],
+                          this_Stack[current]);
+        }
+    }
+
+    /* code used to copy the block out and reduce the pointer index by the
+     * number of items removed, the block is only cleared when secure
+     * clearing is on */
+    memcpy (items, this_Stack + index, count * sizeof(long));
+    if (secure)
+    {
+        memset (this_Stack + index, 0, count * sizeof(long));
+    }
+    this_Stack[STACK_POINTER_INDEX] -= count;
+
+    /* If statement is executed if the stack holds fewer elements than it
+     * has since the newest mark, which makes marks above them stale */
+    if (index < this_Stack[STACK_LOW_INDEX])
+    {
+        this_Stack[STACK_LOW_INDEX] = index;
+    }
+    STATS_ADD (this_Stack, STATS_POPS, count);
+
+    return count;
+}
+
+
 /*-----------------------------------------------------------------------------
 Function Name:          push
 Purpose:                This function adds a new element to the top of stack
@@ -357,14 +973,15 @@ long push (Stack * this_Stack, long item)
     /* If statement is executed if the stack is full */
     if ( isfull_Stack (this_Stack) )
     {
+        STATS_ADD (this_Stack, STATS_PUSH_FULL, 1);
         writeline (PUSH_FULL, stderr);     /* error message printed */
         return 0;
     }
 
     /* If statement is executed if debug mode is on */
-    if (debug)
+    if (TRACING)
     {
-        fprintf (stderr, PUSH, (long)stack_counter, item);
+        trace_record (TRACE_PUSH, this_Stack[STACK_COUNT_INDEX], item);
     }
 
     /* code used to store item into the top of stack and to move to the next
@@ -372,56 +989,530 @@ long push (Stack * this_Stack, long item)
     pointerIndex = this_Stack[STACK_POINTER_INDEX];
     this_Stack[pointerIndex + 1] = item;
     this_Stack[STACK_POINTER_INDEX]++;   
+    STATS_ADD (this_Stack, STATS_PUSHES, 1);
+    STATS_DEPTH (this_Stack);
 
     return 1;
 }
 
 
-/*----------------------------------------------------------------------------
-Function Name:          top
-Purpose:                This function prints the top element in the stack
-Description:            This function first checks to see if the stack has
-                        been set yet or if it is already empty. If so, an
-                        error message is printed. If this is not the case,
-                        then the long pointer is shown and printed
-Input:                  this_Stack: the stack from which we are getting our
-                                    items
-                        item: the number on top of the stack
-Result:                 Ture if there is a top item in the stack. False if 
-                        the stack has yet to be set or is already empty and
-                        an error message is printed
-----------------------------------------------------------------------------*/
-long top (Stack * this_Stack, long * item) 
+/*-----------------------------------------------------------------------------
+Function Name:          push_grow
+Purpose:                This function adds a new element to the top of a
+                        growable stack, expanding the stack when it is full
+Description:            This function checks to see if the stack is full. If
+                        so, the stack is reallocated to STACK_GROWTH times
+                        its current size so that a series of pushes costs
+                        amortized constant time. The push itself is then made
+                        with push. Since the stack may move in memory, the
+                        caller's pointer to the stack is updated
+Input:                  spp: pointer to the stack in question
+                        item: the long being stored to the top of stack
+Result:                 The result of push, or 0 if the stack does not exist
+                        or could not be grown and an error message is printed
+-----------------------------------------------------------------------------*/
+long push_grow (Stack ** spp, long item) 
 {
-    long pointerIndex = 0;  /* variable for original index of pointer index */
+    unsigned long stacksize = 0;    /* size the stack will grow to */
 
-
-    /* If statement is executed when the stack has not been set yet or when
-     * the stack is already empty */
-    if (!this_Stack || this_Stack[STACK_POINTER_INDEX] <= -1)
+    /* If statement is executed if the stack is not yet set */
+    if (!spp || !*spp)
     {
-        writeline (TOP_NONEXIST, stderr);    /* error message printed */
+        writeline (PUSH_NONEXIST, stderr);    /* error message printed */
         return 0;
     }
 
-    pointerIndex = this_Stack[STACK_POINTER_INDEX];
-
-    /* If statement is executed when debug mode is on */
-    if (debug)
+    /* If statement is executed if the stack needs more room */
+    if ( item != EOF && isfull_Stack (*spp) )
     {
-        fprintf (stderr, TOP, (long)stack_counter, 
-                this_Stack[pointerIndex]);
-    }
-    
-    *item = this_Stack[pointerIndex];   /* obtain the top item in stack */
+        stacksize = (*spp)[STACK_SIZE_INDEX] * STACK_GROWTH;
+
+        if (!stacksize)
+        {
+            stacksize = 1;
+        }
+
+        if ( !resize_Stack (spp, stacksize) )
+        {
+            return 0;
+        }
+    }
+
+    return push (*spp, item);
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          push_n
+Purpose:                This function adds a block of items to the top of the
+                        stack in a single call
+Description:            This function validates the stack and the incoming
+                        buffer once, works out how much room is left, and
+                        copies as many items as fit with a single memcpy.
+                        Items are pushed in buffer order, so the last item in
+                        the buffer becomes the new top of the stack. Unlike
+                        push, values are stored as given and EOF is not
+                        treated as a sentinel
+Input:                  this_Stack: the stack in question
+                        items: the buffer of longs being stored
+                        count: the number of items in the buffer
+Result:                 The number of items pushed, which is less than count
+                        when the stack fills up and an error message is
+                        printed. 0 if the stack or buffer does not exist
+-----------------------------------------------------------------------------*/
+long push_n (Stack * this_Stack, const long * items, unsigned long count) 
+{
+    long index = 0;         /* index of the first free space */
+    unsigned long room = 0; /* number of free spaces left on the stack */
+
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (PUSH_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the buffer is not yet set */
+    if (!items)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    index = this_Stack[STACK_POINTER_INDEX] + 1;
+    room = this_Stack[STACK_SIZE_INDEX] - index;
+
+    /* If statement is executed if not every item fits on the stack */
+    if (count > room)
+    {
+        STATS_ADD (this_Stack, STATS_PUSH_FULL, 1);
+        writeline (PUSH_FULL, stderr);     /* error message printed */
+        count = room;
+    }
+
+    /* If statement is executed if debug mode is on */
+    if (TRACING)
+    {
+        unsigned long current = 0;  /* index of the item being reported */
+
+        for (current = 0; current < count; current++)
+        {
+            trace_record (TRACE_PUSH, this_Stack[STACK_COUNT_INDEX],
+                          items[current]);
+        }
+    }
+
+    /* code used to copy the block onto the stack and to move the pointer
+     * index past it */
+    memcpy (this_Stack + index, items, count * sizeof(long));
+    this_Stack[STACK_POINTER_INDEX] += count;
+    STATS_ADD (this_Stack, STATS_PUSHES, count);
+    STATS_DEPTH (this_Stack);
+
+    return count;
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          push_n_grow
+Purpose:                This function adds a block of items to the top of a
+                        growable stack, expanding the stack to fit them
+Description:            This function works out how much room the block needs
+                        and, if the stack is too small, reallocates it to the
+                        larger of STACK_GROWTH times its current size and the
+                        size required. The block is then pushed with push_n.
+                        The caller's pointer to the stack is updated
+Input:                  spp: pointer to the stack in question
+                        items: the buffer of longs being stored
+                        count: the number of items in the buffer
+Result:                 The number of items pushed, 0 if the stack does not
+                        exist or could not be grown and an error message is
+                        printed
+-----------------------------------------------------------------------------*/
+long push_n_grow (Stack ** spp, const long * items, unsigned long count) 
+{
+    unsigned long needed = 0;       /* size required to hold the block */
+    unsigned long stacksize = 0;    /* size the stack will grow to */
+
+    /* If statement is executed if the stack is not yet set */
+    if (!spp || !*spp)
+    {
+        writeline (PUSH_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    needed = (*spp)[STACK_POINTER_INDEX] + 1 + count;
+    stacksize = (*spp)[STACK_SIZE_INDEX];
+
+    /* If statement is executed if the stack needs more room */
+    if (needed > stacksize)
+    {
+        stacksize *= STACK_GROWTH;
+
+        if (stacksize < needed)
+        {
+            stacksize = needed;
+        }
+
+        if ( !resize_Stack (spp, stacksize) )
+        {
+            return 0;
+        }
+    }
+
+    return push_n (*spp, items, count);
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          renumber_Stack
+Purpose:                This function gives a stack a new number
+Description:            This function takes the next number from the counter
+                        that numbers every stack as it is made, for stacks
+                        whose header is set up outside stack.c, such as a
+                        file-backed stack being created or reopened
+Input:                  this_Stack: the stack being numbered
+Result:                 The new number, or 0 if the stack does not exist and
+                        an error message is printed
+-----------------------------------------------------------------------------*/
+long renumber_Stack (Stack * this_Stack) 
+{
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (RENUMBER_NONEXIST, stderr);     /* error message printed */
+        return 0;
+    }
+
+    this_Stack[STACK_COUNT_INDEX] = 
+        atomic_fetch_add_explicit (&stack_serial, 1, memory_order_relaxed) + 1;
+
+    return this_Stack[STACK_COUNT_INDEX];
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          reserve_Stack
+Purpose:                This function makes sure a stack can hold at least
+                        the given number of elements
+Description:            This function checks the size stored in the stack
+                        header and reallocates the stack if it is smaller
+                        than requested. The caller's pointer to the stack is
+                        updated since the stack may move in memory
+Input:                  spp: pointer to the stack in question
+                        stacksize: the number of longs the stack should hold
+Result:                 True if the stack can hold stacksize elements. False
+                        if the stack does not exist or could not be grown and
+                        an error message is printed
+-----------------------------------------------------------------------------*/
+long reserve_Stack (Stack ** spp, unsigned long stacksize) 
+{
+    /* If statement is executed if the stack is not yet set */
+    if (!spp || !*spp)
+    {
+        writeline (GROW_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the stack is already large enough */
+    if ( (unsigned long)(*spp)[STACK_SIZE_INDEX] >= stacksize )
+    {
+        return 1;
+    }
+
+    return resize_Stack (spp, stacksize);
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          reserved_Stack
+Purpose:                This function reports the memory behind a stack
+Description:            This function works out the bytes of the block from
+                        its kind: the whole size class for a pooled block,
+                        the length kept below the header for a placed block,
+                        and the header and user data otherwise
+Input:                  this_Stack: the stack in question
+Result:                 The number of bytes, or 0 if the stack does not exist
+                        and an error message is printed
+-----------------------------------------------------------------------------*/
+long reserved_Stack (Stack * this_Stack) 
+{
+    long class = 0;         /* size class of the block */
+
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (RESERVED_NONEXIST, stderr);     /* error message printed */
+        return 0;
+    }
+
+    class = this_Stack[STACK_BLOCK_INDEX];
+
+    /* If statement is executed for a pooled block */
+    if (class >= 0)
+    {
+        return (1L << class) * sizeof(long);
+    }
+
+    /* If statement is executed for a placed block */
+    if (class == STACK_PLACED)
+    {
+        return PLACED_BASE (this_Stack)[PLACED_LENGTH];
+    }
+
+    return (this_Stack[STACK_SIZE_INDEX] + STACK_OFFSET) * sizeof(long);
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          rollback_Stack
+Purpose:                This function unwinds the stack back to a mark
+Description:            This function looks the mark up among the epochs
+                        kept beside the stack, the newest first. Since a
+                        stamp is never given to two epochs, a mark of
+                        another stack is never found. The mark is stale if
+                        the stack has held fewer elements than when it was
+                        taken, which pop, pop_n, rollback_Stack and
+                        empty_Stack all record in the header. Otherwise
+                        everything pushed since is removed by setting the
+                        stack pointer back, whatever the number of
+                        elements. Removed values are only cleared when
+                        secure clearing is on and only traced when debug
+                        mode is on
+Input:                  this_Stack: the stack in question
+                        mark: a mark from mark_Stack
+Result:                 True if the stack was rolled back. False if the
+                        stack does not exist, the mark is another stack's or
+                        the stack has held fewer elements since it was taken
+                        and an error message is printed
+-----------------------------------------------------------------------------*/
+long rollback_Stack (Stack * this_Stack, long mark) 
+{
+    MarkTable * marks = 0;  /* the marks of the stack */
+    long depth = -1;        /* elements when marked, -1 if never marked */
+    long index = 0;         /* index of the older epoch being checked */
+    long count = 0;         /* number of elements removed */
+
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (ROLLBACK_NONEXIST, stderr);     /* error message printed */
+        return 0;
+    }
+
+    marks = MARKS_OF (this_Stack);
+
+    /* If statement is executed if the stack has been marked, when the
+     * epoch of the mark is looked for */
+    if (marks && mark > 0)
+    {
+        /* If statement is executed if it is a mark of the newest epoch */
+        if (mark == marks->stamp)
+        {
+            depth = marks->depth;
+        }
+
+        for (index = marks->count - 1; depth < 0 && index >= 0; index--)
+        {
+            /* If statement is executed if it is a mark of this epoch */
+            if (mark == marks->older[index].stamp)
+            {
+                depth = marks->older[index].depth;
+            }
+        }
+    }
+
+    /* If statement is executed if the mark is not this stack's or the
+     * stack has held fewer elements since it was taken */
+    if ( depth < 0 || depth > this_Stack[STACK_LOW_INDEX] )
+    {
+        writeline (ROLLBACK_STALE, stderr);        /* error message printed */
+        return 0;
+    }
+
+    count = this_Stack[STACK_POINTER_INDEX] + 1 - depth;
+
+    /* If statement is executed when debug mode is on, messages are
+     * printed in the same order a series of pops would print them */
+    if (TRACING)
+    {
+        long current = 0;   /* index of the item being reported */
+
+        for (current = depth + count - 1; current >= depth; current--)
+        {
+            trace_record (TRACE_POP, this_Stack[STACK_COUNT_INDEX],
+                          this_Stack[current]);
+        }
+    }
+
+    /* If statement is executed when secure clearing is on */
+    if (secure)
+    {
+        memset (this_Stack + depth, 0, count * sizeof(long));
+    }
+    this_Stack[STACK_POINTER_INDEX] = depth - 1;
+    this_Stack[STACK_LOW_INDEX] = depth;
+    STATS_ADD (this_Stack, STATS_POPS, count);
+
+    return 1;
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          shrink_Stack
+Purpose:                This function releases the unused space of a stack
+Description:            This function reallocates the stack so that its size
+                        matches the number of elements it currently holds.
+                        A pooled stack only moves when that size falls in a
+                        smaller size class, whose block it takes, giving its
+                        own back to the pool. Within its class only the size
+                        in the header changes and no memory is freed. The
+                        caller's pointer to the stack is updated since the
+                        stack may move in memory
+Input:                  spp: pointer to the stack in question
+Result:                 True if the stack was shrunk. False if the stack does
+                        not exist or could not be reallocated and an error
+                        message is printed
+-----------------------------------------------------------------------------*/
+long shrink_Stack (Stack ** spp) 
+{
+    /* If statement is executed if the stack is not yet set */
+    if (!spp || !*spp)
+    {
+        writeline (SHRINK_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    return resize_Stack (spp, (*spp)[STACK_POINTER_INDEX] + 1);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          top
+Purpose:                This function prints the top element in the stack
+Description:            This function first checks to see if the stack has
+                        been set yet or if it is already empty. If so, an
+                        error message is printed. If this is not the case,
+                        then the long pointer is shown and printed
+Input:                  this_Stack: the stack from which we are getting our
+                                    items
+                        item: the number on top of the stack
+Result:                 Ture if there is a top item in the stack. False if 
+                        the stack has yet to be set or is already empty and
+                        an error message is printed
+----------------------------------------------------------------------------*/
+long top (Stack * this_Stack, long * item) 
+{
+    long pointerIndex = 0;  /* variable for original index of pointer index */
+
+
+    /* If statement is executed when the stack has not been set yet or when
+     * the stack is already empty */
+    if (!this_Stack || this_Stack[STACK_POINTER_INDEX] <= -1)
+    {
+        if (this_Stack)
+        {
+            STATS_ADD (this_Stack, STATS_TOP_EMPTY, 1);
+        }
+        writeline (TOP_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    pointerIndex = this_Stack[STACK_POINTER_INDEX];
+    STATS_ADD (this_Stack, STATS_TOPS, 1);
+
+    /* If statement is executed when debug mode is on */
+    if (TRACING)
+    {
+        trace_record (TRACE_TOP, this_Stack[STACK_COUNT_INDEX],
+                      this_Stack[pointerIndex]);
+    }
+    
+    *item = this_Stack[pointerIndex];   /* obtain the top item in stack */
 
     return 1;
 }
 
 
+/*----------------------------------------------------------------------------
+Function Name:          top_n
+Purpose:                This function copies a block of items from the top of
+                        the stack without removing them
+Description:            This function behaves like pop_n, copying up to count
+                        items in stack order into the buffer with a single
+                        memcpy, but leaves the stack unaffected
+Input:                  this_Stack: the stack from which we are getting our
+                                    items
+                        items: the buffer receiving the copied items
+                        count: the number of items requested
+Result:                 The number of items copied, which is less than count
+                        when the stack holds fewer items. 0 if the stack or
+                        buffer does not exist or the stack is empty and an
+                        error message is printed
+----------------------------------------------------------------------------*/
+long top_n (Stack * this_Stack, long * items, unsigned long count) 
+{
+    long available = 0;     /* number of items currently on the stack */
+    long index = 0;         /* index of the first item being copied */
+
+    /* If statement is executed when the stack has not been set yet */
+    if (!this_Stack)
+    {
+        writeline (TOP_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed when the buffer has not been set yet */
+    if (!items)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return 0;
+    }
+
+    available = this_Stack[STACK_POINTER_INDEX] + 1;
+
+    /* If statement is executed when the stack is already empty */
+    if (available <= 0)
+    {
+        STATS_ADD (this_Stack, STATS_TOP_EMPTY, 1);
+        writeline (TOP_EMPTY, stderr);    /* error message printed */
+        return 0;
+    }
+
+    /* only copy as many items as the stack holds */
+    if (count > (unsigned long)available)
+    {
+        count = available;
+    }
+
+    index = available - count;
+
+    /* If statement is executed when debug mode is on */
+    if (TRACING)
+    {
+        long current = 0;   /* index of the item being reported */
+
+        for (current = available - 1; current >= index; current--)
+        {
+            trace_record (TRACE_TOP, this_Stack[STACK_COUNT_INDEX],
+                          this_Stack[current]);
+        }
+    }
+
+    /* copy the top block of the stack */
+    memcpy (items, this_Stack + index, count * sizeof(long));
+    STATS_ADD (this_Stack, STATS_TOPS, count);
+
+    return count;
+}
+
+
 FILE * write_Stack (Stack * this_Stack, FILE * stream) 
 {
+    char buffer[WRITE_BUFFER];  /* text waiting to be written */
+    long count = 0;         /* number of elements on the stack */
     long index = 0;         /* index into the stack */
+    long length = 0;        /* characters in the buffer */
 
     if (this_Stack == NULL) 
     {
@@ -435,33 +1526,568 @@ FILE * write_Stack (Stack * this_Stack, FILE * stream)
         return stream;
     }
                 
+    count = num_elements (this_Stack);
+
     if (stream == stderr)
     {
-        fprintf ( stream, "Stack has %ld items in it.\n", 
-                num_elements (this_Stack) );
+        fprintf (stream, "Stack has %ld items in it.\n", count);
+
+        for (index = 0; index < count; index++) 
+        {
+            fprintf (stream, "Value on stack is |0x%lx|\n", this_Stack[index]);
+        }
+
+        return stream;
     }
 
-    for (index = STACK_COUNT_INDEX + STACK_OFFSET;
-            index < num_elements (this_Stack); index++) 
+    /* other streams get the values converted into a buffer that is written
+     * out whenever it cannot hold another value */
+
+    for (index = 0; index < count; index++) 
     {
-        if (stream == stderr)
+        if (length > WRITE_BUFFER - DECOUT_SIZE - 1)
         {
-            fprintf (stream, "Value on stack is |0x%lx|\n", this_Stack[index]);
+            fwrite (buffer, 1, length, stream);
+            length = 0;
         }
 
-        else 
+        if (this_Stack[index] < 0)
         {
-            if (this_Stack[index] < 0)
-            {
-                fprintf (stream, "%c ", (char) this_Stack[index]);
-            }
-                        
-            else
-            {
-                fprintf (stream, "%ld ", this_Stack[index]);
-            }
+            buffer[length++] = (char) this_Stack[index];
+        }
+                    
+        else
+        {
+            length += sdecout (this_Stack[index], buffer + length);
         }
+
+        buffer[length++] = ' ';
     }
 
+    fwrite (buffer, 1, length, stream);
+
     return stream;
 }
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          checksum_Stack
+Purpose:                This function computes the checksum stored in a dump
+Description:            This function mixes the elements into an FNV-1a style
+                        hash a whole long at a time, so the checksum keeps up
+                        with reading and writing the elements
+Input:                  this_Stack: the stack being checked
+                        count: the number of elements to include
+Result:                 The checksum of the first count elements
+-----------------------------------------------------------------------------*/
+static unsigned long checksum_Stack (Stack * this_Stack, long count) 
+{
+    unsigned long hash = DUMP_SEED;     /* checksum so far */
+    long index = 0;                     /* index into the stack */
+
+    for (index = 0; index < count; index++)
+    {
+        hash = (hash ^ (unsigned long)this_Stack[index]) * DUMP_PRIME;
+    }
+
+    return hash;
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          get_block
+Purpose:                This function obtains the memory behind a new stack
+Description:            This function works out the size class of the stack.
+                        When the pool is on and the class is pooled, a free
+                        block of that class is reused, or a new one allocated
+                        at the full class size. Otherwise a block of exactly
+                        the needed size is allocated. Either way the size
+                        class, or STACK_UNPOOLED for an unpooled block, is
+                        recorded at STACK_BLOCK_INDEX
+Input:                  stacksize: number of longs the stack will hold
+Result:                 A pointer to where user data begins, or NULL if the
+                        size overflows or memory could not be allocated
+-----------------------------------------------------------------------------*/
+static Stack * get_block (unsigned long stacksize) 
+{
+    long class = STACK_UNPOOLED;    /* size class of the block */
+    void * memory = 0;      /* the block obtained */
+
+    /* If statement is executed if the size overflows the allocation */
+    if (stacksize > (unsigned long)-1 / sizeof(long) - STACK_OFFSET)
+    {
+        return NULL;
+    }
+
+    /* If statement is executed if the block can come from the pool */
+    if ( pool && (class = size_class (stacksize)) >= 0 )
+    {
+        if ( (memory = pool_list[class]) )
+        {
+            pool_list[class] = *(void **)memory;
+            pool_count[class]--;
+        }
+        else
+        {
+            memory = allocate ( (1UL << class) * sizeof(long) );
+        }
+    }
+    else
+    {
+        class = STACK_UNPOOLED;
+        memory = allocate ( (stacksize + STACK_OFFSET) * sizeof(long) );
+    }
+
+    /* If statement is executed if memory could not be allocated */
+    if (!memory)
+    {
+        return NULL;
+    }
+
+    ((Stack *)memory + STACK_OFFSET)[STACK_BLOCK_INDEX] = class;
+    ((Stack *)memory + STACK_OFFSET)[STACK_SIZE_INDEX] = stacksize;
+    STATS_RESERVE ( reserved_Stack ((Stack *)memory + STACK_OFFSET) );
+
+    return (Stack *)memory + STACK_OFFSET;
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          get_placed
+Purpose:                This function obtains the memory behind a new placed
+                        stack
+Description:            This function leaves PLACED_PAD longs, a whole number
+                        of cache lines, ahead of the user data, for the
+                        header and, below it, the length, options and node
+                        of the block. Blocks asking for neither huge pages
+                        nor a node come from aligned_alloc and the rest are
+                        mapped by map_placed. STACK_PLACED is recorded at
+                        STACK_BLOCK_INDEX
+Input:                  stacksize: number of longs the stack will hold
+                        options: 0 or STACK_HUGE_PAGES
+                        node: the preferred NUMA node, or STACK_ANY_NODE
+Result:                 A pointer to where user data begins, or NULL if the
+                        size overflows or memory could not be obtained
+-----------------------------------------------------------------------------*/
+static Stack * get_placed (unsigned long stacksize, long options, long node) 
+{
+    unsigned long length = 0;   /* bytes in the block */
+    Stack * base = 0;           /* start of the block */
+
+    /* If statement is executed if the size overflows the allocation */
+    if (stacksize > ((unsigned long)-1 - HUGE_PAGE) / sizeof(long) 
+                    - PLACED_PAD)
+    {
+        return NULL;
+    }
+
+    length = (stacksize + PLACED_PAD) * sizeof(long);
+
+    /* If statement is executed if the block can come from the heap */
+    if ( !PLACED_MAPPED (options, node) )
+    {
+        length = (length + CACHE_LINE - 1) / CACHE_LINE * CACHE_LINE;
+        base = aligned_alloc (CACHE_LINE, length);
+    }
+    else
+    {
+        base = map_placed (&length, options, node);
+    }
+
+    /* If statement is executed if memory could not be obtained */
+    if (!base)
+    {
+        return NULL;
+    }
+
+    base[PLACED_LENGTH] = length;
+    base[PLACED_OPTIONS] = options;
+    base[PLACED_NODE] = node;
+    base[PLACED_PAD + STACK_BLOCK_INDEX] = STACK_PLACED;
+    STATS_RESERVE (length);
+
+    return base + PLACED_PAD;
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          grow_marks
+Purpose:                This function makes room for the marks of a stack
+Description:            This function allocates the marks of a stack that has
+                        never been marked, with room for MARKS_ROOM older
+                        epochs, or doubles the room of its marks, and points
+                        the STACK_MARKS_INDEX slot of the header at them
+Input:                  this_Stack: the stack in question
+Result:                 The marks, or NULL if memory could not be allocated,
+                        in which case the marks are left as they were
+-----------------------------------------------------------------------------*/
+static MarkTable * grow_marks (Stack * this_Stack) 
+{
+    MarkTable * marks = MARKS_OF (this_Stack);  /* the marks so far */
+    long room = marks ? marks->room * 2 : MARKS_ROOM;   /* room wanted */
+
+    marks = realloc (marks, sizeof(MarkTable) + room * sizeof(MarkEpoch));
+
+    /* If statement is executed if memory could not be allocated */
+    if (!marks)
+    {
+        return NULL;
+    }
+
+    /* If statement is executed if the stack has never been marked */
+    if ( !MARKS_OF (this_Stack) )
+    {
+        marks->stamp = 0;
+        marks->depth = 0;
+        marks->count = 0;
+    }
+
+    marks->room = room;
+    this_Stack[STACK_MARKS_INDEX] = (long)marks;
+
+    return marks;
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          map_placed
+Purpose:                This function maps the memory behind a placed stack
+Description:            This function rounds the length up to whole pages.
+                        For huge pages it is rounded to whole huge pages and
+                        mapped from the reserved huge pages, or when none are
+                        reserved mapped as usual with transparent huge pages
+                        asked for. A preferred node is then set on the
+                        mapping before any page of it is touched. Both the
+                        huge pages and the node are hints: the block is
+                        still given if the system cannot follow them
+Input:                  length: bytes needed, updated to bytes mapped
+                        options: 0 or STACK_HUGE_PAGES
+                        node: the preferred NUMA node, or STACK_ANY_NODE
+Result:                 The start of the mapping, or NULL if it failed
+-----------------------------------------------------------------------------*/
+static void * map_placed (unsigned long * length, long options, long node) 
+{
+    unsigned long page = sysconf (_SC_PAGESIZE);  /* bytes in a page */
+    unsigned long mask[NODE_WORDS];   /* the node as a mask for mbind */
+    void * memory = MAP_FAILED;       /* the mapping */
+
+    /* If statement is executed if huge pages were asked for */
+    if (options & STACK_HUGE_PAGES)
+    {
+        *length = (*length + HUGE_PAGE - 1) / HUGE_PAGE * HUGE_PAGE;
+        memory = mmap (NULL, *length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+    else
+    {
+        *length = (*length + page - 1) / page * page;
+    }
+
+    /* If statement is executed if no huge pages were reserved for the
+     * mapping or none were asked for */
+    if (memory == MAP_FAILED)
+    {
+        memory = mmap (NULL, *length, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (memory != MAP_FAILED && (options & STACK_HUGE_PAGES))
+        {
+            madvise (memory, *length, MADV_HUGEPAGE);
+        }
+    }
+
+    /* If statement is executed if the memory could not be mapped */
+    if (memory == MAP_FAILED)
+    {
+        return NULL;
+    }
+
+    /* If statement is executed if a node the mask can hold was asked for */
+    if (node >= 0 && node < NODE_WORDS * 8 * (long)sizeof(long))
+    {
+        memset (mask, 0, sizeof(mask));
+        mask[node / (8 * sizeof(long))] |= 1UL << node % (8 * sizeof(long));
+        syscall (SYS_mbind, memory, *length, PREFER_NODE, mask, 
+                 NODE_WORDS * 8 * sizeof(long) + 1, 0);
+    }
+
+    return memory;
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          new_stamp
+Purpose:                This function gives out a mark stamp
+Description:            This function hands out the calling thread's batch
+                        of stamps, taking a new batch of STAMP_BATCH from the
+                        counter shared by every thread when it runs out, so
+                        that most marks need no atomic instruction and no
+                        two epochs of any stacks share a stamp
+Input:                  None
+Result:                 A stamp, always positive
+-----------------------------------------------------------------------------*/
+static long new_stamp (void) 
+{
+    /* If statement is executed if this thread's batch is used up */
+    if (stamp_next == stamp_end)
+    {
+        stamp_next = atomic_fetch_add_explicit (&mark_stamp, STAMP_BATCH,
+                                                memory_order_relaxed) + 1;
+        stamp_end = stamp_next + STAMP_BATCH;
+    }
+
+    return stamp_next++;
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          put_block
+Purpose:                This function gives back the memory behind a stack
+Description:            This function keeps a pooled block on the free list of
+                        its size class while the pool is on and the list is
+                        not yet POOL_DEPTH long. When secure clearing is on,
+                        the used part of the block is zeroed first. Any other
+                        block is released to the allocator, except a placed
+                        block, which goes back the way it was obtained, and
+                        an inline block, which belongs to the caller
+Input:                  this_Stack: the stack whose memory is given back
+Result:                 The block is pooled or released
+-----------------------------------------------------------------------------*/
+static void put_block (Stack * this_Stack) 
+{
+    long class = this_Stack[STACK_BLOCK_INDEX];   /* size class of block */
+    void * memory = this_Stack - STACK_OFFSET;    /* start of the block */
+
+    /* If statement is executed if the block belongs to the caller, which
+     * is left in place with only its values cleared */
+    if (class == STACK_INLINE)
+    {
+        if (secure)
+        {
+            memset (this_Stack, 0, 
+                    (this_Stack[STACK_POINTER_INDEX] + 1) * sizeof(long));
+        }
+        return;
+    }
+
+    STATS_RESERVE ( -reserved_Stack (this_Stack) );
+
+    /* If statement is executed if the block was placed, which is unmapped
+     * or freed the way it was obtained */
+    if (class == STACK_PLACED)
+    {
+        Stack * base = PLACED_BASE (this_Stack);  /* start of the block */
+
+        if ( PLACED_MAPPED (base[PLACED_OPTIONS], base[PLACED_NODE]) )
+        {
+            munmap (base, base[PLACED_LENGTH]);
+        }
+        else
+        {
+            free (base);
+        }
+        return;
+    }
+
+    /* If statement is executed if the block can be kept in the pool */
+    if (pool && class >= 0 && pool_count[class] < POOL_DEPTH)
+    {
+        if (secure)
+        {
+            memset (this_Stack, 0, 
+                    (this_Stack[STACK_POINTER_INDEX] + 1) * sizeof(long));
+        }
+
+        *(void **)memory = pool_list[class];
+        pool_list[class] = memory;
+        pool_count[class]++;
+        return;
+    }
+
+    release (memory);
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          resize_Stack
+Purpose:                This function changes the number of longs a stack can
+                        hold
+Description:            This function first checks whether a pooled stack
+                        still fits in its block, in which case only the size
+                        in the header changes, and leaves an inline stack
+                        that is not growing as it is. Otherwise a pooled or
+                        inline stack is moved to a block of the right class,
+                        and a placed stack to a new block placed alike,
+                        copying the header and the elements, and an
+                        unpooled stack is reallocated whole, so the stack
+                        count, size and pointer move along with the user
+                        data. Large blocks are moved by the C library
+                        without copying where it can. The size stored in
+                        the header is then updated and the caller's pointer
+                        is set to where user data now begins
+Input:                  spp: pointer to the stack being resized
+                        stacksize: the new number of longs the stack holds,
+                                   never fewer than the number of elements
+Result:                 True if the stack was resized. False if memory could
+                        not be allocated, in which case the stack is left
+                        unaffected and an error message is printed
+-----------------------------------------------------------------------------*/
+static long resize_Stack (Stack ** spp, unsigned long stacksize) 
+{
+    long class = (*spp)[STACK_BLOCK_INDEX];   /* size class of the block */
+    Stack * this_Stack = 0;                   /* the resized stack */
+    void * memory = 0;                        /* the reallocated block */
+
+    /* If statement is executed if the size overflows the allocation */
+    if (stacksize > (unsigned long)-1 / sizeof(long) - STACK_OFFSET)
+    {
+        writeline (GROW_FAILED, stderr);      /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the stack lives in a file */
+    if (class == STACK_MAPPED)
+    {
+        writeline (GROW_MAPPED, stderr);      /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if a pooled stack stays in its size class */
+    if ( class >= 0 && size_class (stacksize) == class )
+    {
+        (*spp)[STACK_SIZE_INDEX] = stacksize;
+        return 1;
+    }
+
+    /* If statement is executed if an inline stack is not growing, which
+     * keeps its storage and size rather than move to the heap */
+    if ( class == STACK_INLINE && 
+         stacksize <= (unsigned long)(*spp)[STACK_SIZE_INDEX] )
+    {
+        return 1;
+    }
+
+    /* If statement is executed if a pooled, placed or inline stack moves
+     * to another block, a placed one keeping its options and node */
+    if (class >= 0 || class == STACK_PLACED || class == STACK_INLINE)
+    {
+        this_Stack = class != STACK_PLACED ? get_block (stacksize) :
+            get_placed (stacksize, 
+                        PLACED_BASE (*spp)[PLACED_OPTIONS],
+                        PLACED_BASE (*spp)[PLACED_NODE]);
+
+        /* If statement is executed if the new block was not allocated */
+        if (!this_Stack)
+        {
+            writeline (GROW_FAILED, stderr);      /* error message printed */
+            return 0;
+        }
+
+        /* the header and elements are copied in one go, the new block
+         * keeping its own size class */
+        class = this_Stack[STACK_BLOCK_INDEX];
+        memcpy (this_Stack - STACK_OFFSET, *spp - STACK_OFFSET, 
+                ((*spp)[STACK_POINTER_INDEX] + 1 + STACK_OFFSET) 
+                * sizeof(long));
+        this_Stack[STACK_BLOCK_INDEX] = class;
+        put_block (*spp);
+    }
+    else
+    {
+        memory = reallocate (*spp - STACK_OFFSET,
+                             (stacksize + STACK_OFFSET) * sizeof(long) );
+
+        /* If statement is executed if the reallocation failed */
+        if (!memory)
+        {
+            writeline (GROW_FAILED, stderr);      /* error message printed */
+            return 0;
+        }
+
+        this_Stack = (Stack *)memory + STACK_OFFSET;
+        STATS_RESERVE ( ((long)stacksize - this_Stack[STACK_SIZE_INDEX])
+                        * (long)sizeof(long) );
+    }
+
+    this_Stack[STACK_SIZE_INDEX] = stacksize;
+    *spp = this_Stack;
+
+    return 1;
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          size_class
+Purpose:                This function finds the pool size class of a stack
+Description:            This function finds the smallest power of two, no
+                        smaller than 1 << POOL_MIN_CLASS, that holds the
+                        stack and its header
+Input:                  stacksize: number of longs the stack holds
+Result:                 The size class, or STACK_UNPOOLED if the stack is too
+                        large to be pooled
+-----------------------------------------------------------------------------*/
+static long size_class (unsigned long stacksize) 
+{
+    long class = POOL_MIN_CLASS;    /* size class being tried */
+
+    /* If statement is executed if the stack is too large to be pooled */
+    if (stacksize > (1UL << POOL_MAX_CLASS) - STACK_OFFSET)
+    {
+        return STACK_UNPOOLED;
+    }
+
+    while ( (1UL << class) < stacksize + STACK_OFFSET )
+    {
+        class++;
+    }
+
+    return class;
+}
+
+
+/*-----------------------------------------------------------------------------
+Function Name:          start_Stack
+Purpose:                This function initializes a newly obtained stack
+Description:            This function sets up the header of the block that
+                        new_Stack or new_placed_Stack obtained
+Input:                  this_Stack: where user data of the block begins, or
+                                    NULL if no block was obtained
+                        stacksize: number of longs the block holds
+Result:                 The stack, or NULL if there was no block and an error
+                        message is printed
+-----------------------------------------------------------------------------*/
+static Stack * start_Stack (Stack * this_Stack, unsigned long stacksize) 
+{
+    /* If statement is executed when memory could not be allocated */
+    if (!this_Stack)
+    {
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    /* new stack starts at an index of -1 and is not watched */
+    this_Stack[STACK_POINTER_INDEX] = -1;
+    this_Stack[STACK_STATS_INDEX] = 0;
+
+    /* stores the size of stack  */
+    this_Stack[STACK_SIZE_INDEX] = stacksize;
+
+    /* no mark has been taken, so none is kept */
+    this_Stack[STACK_LOW_INDEX] = 0;
+    this_Stack[STACK_MARKS_INDEX] = 0;
+
+    /* numbers the stack, no two stacks of the process sharing a number */
+    renumber_Stack (this_Stack);
+
+    /* incrementation of stack counter to keep track of how many data 
+     * structures are allocated */
+    atomic_fetch_add_explicit (&stack_counter, 1, memory_order_relaxed);
+
+    /* If statement is executed when debug mode is on */
+    if (TRACING)
+    {
+        trace_record (TRACE_ALLOCATE, this_Stack[STACK_COUNT_INDEX], 0);
+    }
+
+    return this_Stack;
+}
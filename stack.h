@@ -4,40 +4,184 @@
 #include <stdio.h>
 
 /* This array implementation of stack is an array of longs (words), the
-stack count is the first element in the array, the stack size is the second
-element in the array, and the stack pointer is the third element in the
-array.  The stack pointer has the value of an index into the array to denote
-the last used space in the stack. */
+pointer to the stack's own statistics counters (stats.h) is the first
+element in the array, followed by the pointer to the marks mark_Stack keeps
+beside the stack, the fewest elements the stack has held since its newest
+mark, the pool size class, the stack count, the stack size and the stack
+pointer.  The stack pointer has the
+value of an index into the array to denote the last used space in the
+stack.  The header is the same whatever the stack is built with. */
 
 typedef long Stack;
 
+#define STACK_POINTER_INDEX (-1)        /* Index of last used space */
+#define STACK_SIZE_INDEX (-2)           /* Index of size of the stack */
+#define STACK_COUNT_INDEX (-3)          /* Index of which stack allocated */
+#define STACK_BLOCK_INDEX (-4)          /* Index of pool size class or kind
+                                           of block */
+#define STACK_LOW_INDEX (-5)            /* Index of fewest elements held
+                                           since the newest mark */
+#define STACK_MARKS_INDEX (-6)          /* Index of the stack's marks, or 0 */
+#define STACK_STATS_INDEX (-7)          /* Index of the stack's own
+                                           counters, or 0 */
+
+#define STACK_OFFSET 7                  /* offset from allocation to where
+                                          user info begins */
+
+#define STACK_UNPOOLED (-1)     /* size class of a block from the allocator */
+#define STACK_MAPPED (-2)       /* size class of a file-backed stack */
+#define STACK_PLACED (-3)       /* size class of a new_placed_Stack block */
+#define STACK_INLINE (-4)       /* size class of a new_inline_Stack block */
+
+#define STACK_HUGE_PAGES 1      /* new_placed_Stack option for huge pages */
+#define STACK_ANY_NODE (-1)     /* new_placed_Stack NUMA node for no hint */
+
+/* A stack of a fixed capacity can live in place, in a struct or on the C
+call stack, without a heap allocation.  STACK_BUFFER(capacity) is the type
+of its storage and NEW_INLINE_STACK sets a stack up in such storage, for
+use with every function here:
+
+    STACK_BUFFER(16) buffer;
+    Stack * small = NEW_INLINE_STACK(buffer);
+
+The storage holds the same header as every other stack, STACK_OFFSET
+longs: seven, or 56 bytes on LP64, so any function may take an inline
+stack and a growable one can move it to the heap with one copy.  The marks
+and counters are not in the header; they are kept beside a stack only once
+mark_Stack or stats_watch is used on it, and that is the one heap
+allocation an inline stack can make.
+
+push_grow and the other growable functions move a full inline stack to the
+heap, updating the pointer, and delete_Stack then frees the heap block.
+delete_Stack on a stack still inline frees its marks and counters and
+leaves the storage to its owner. */
+#define STACK_BUFFER(capacity) \
+    struct { long longs[STACK_OFFSET + (capacity)]; }
+#define NEW_INLINE_STACK(buffer) \
+    new_inline_Stack ((buffer).longs, \
+                      sizeof((buffer).longs) / sizeof(long) - STACK_OFFSET)
+
 void delete_Stack (Stack **);   /* deallocates memory allocated in new_Stack.
                                    Assigns incoming pointer to NULL. */
-void empty_Stack (Stack *);     /* empties the stack */
+void detach_Stack (Stack *);    /* frees what is kept beside the stack, its
+                                   marks and own counters, leaving the stack
+                                   as it is and refusing its earlier marks.
+                                   delete_Stack and close_PStack call it */
+long dump_Stack (Stack *, FILE *, long); /* writes the stack to the FILE
+                                   in binary, with a checksum when the last
+                                   parameter is non-0.  Result is 0 or non-0
+                                   indicating failure or success,
+                                   respectively */
+void empty_Stack (Stack *);     /* empties the stack in constant time,
+                                   clearing old values only when secure
+                                   clearing is on */
 long isempty_Stack (Stack *);   /* returns 0 or non-0 value indicating
                                    whether or not the stack is empty */
 long isfull_Stack (Stack *);    /* returns 0 or non-0 value indicating
                                    whether or not the stack is full */
+Stack * load_Stack (FILE *);    /* allocates a stack holding what
+                                   dump_Stack wrote to the FILE.  Result is
+                                   a pointer in the array where user data
+                                   allotment begins, or NULL on failure */
+long mark_Stack (Stack *);      /* marks the current depth of the stack
+                                   for rollback_Stack, keeping the marks
+                                   beside the stack.  Result is the mark,
+                                   which no other stack ever gives, or -1
+                                   on failure */
 Stack * new_Stack (unsigned long); /* allocates stack array, and initializes
                                    stack pointer.  Result is a pointer in the
                                    array where user data allotment begins */
+Stack * new_inline_Stack (long *, unsigned long); /* sets up a stack of
+                                   the given number of longs in storage of
+                                   STACK_OFFSET more longs, which is never
+                                   freed.  Result is the same as new_Stack */
+Stack * new_placed_Stack (unsigned long, long, long); /* allocates stack
+                                   array as new_Stack does, with user data
+                                   on a cache line boundary and the header
+                                   on cache lines of its own.  The options
+                                   may ask for STACK_HUGE_PAGES, and the
+                                   last parameter names the NUMA node to
+                                   prefer, or is STACK_ANY_NODE.  Result is
+                                   the same as new_Stack */
 long num_elements (Stack *);     /* returns the number of elements stored
                                    on the stack. */
 long pop (Stack *, long *);     /* removes and sends back the top element of
                                    the stack.  Result is 0 or non-0,
                                    indicating failure or success,
                                    respectively */
+long pop_n (Stack *, long *, unsigned long); /* removes up to the given
+                                   number of elements from the top of the
+                                   stack into the buffer in stack order, so
+                                   the last buffer element is the old top.
+                                   Result is the number of elements removed,
+                                   0 on failure */
 long push (Stack *, long);      /* places one value on the specified stack.
                                    Result is 0 or non-0 indicating failure
                                    or success, respectively */
+long push_grow (Stack **, long);  /* places one value on the specified
+                                   stack, growing the stack geometrically
+                                   when it is full.  Incoming pointer is
+                                   updated.  Result is the same as push */
+long push_n (Stack *, const long *, unsigned long); /* places the buffer
+                                   of values on the stack in buffer order,
+                                   stopping when the stack is full.  Result
+                                   is the number of values pushed, 0 on
+                                   failure */
+long push_n_grow (Stack **, const long *, unsigned long); /* places the
+                                   buffer of values on the stack, growing
+                                   the stack to fit them.  Incoming pointer
+                                   is updated.  Result is the same as
+                                   push_n */
+long renumber_Stack (Stack *);  /* gives the stack a new number, never
+                                   given to another stack, as new_Stack
+                                   does.  Result is the number, or 0 if the
+                                   stack does not exist */
+long reserve_Stack (Stack **, unsigned long); /* grows the stack so it can
+                                   hold at least the given number of
+                                   elements.  Incoming pointer is updated.
+                                   Result is 0 or non-0 indicating failure
+                                   or success, respectively */
+long reserved_Stack (Stack *);  /* returns the number of bytes of memory
+                                   behind the stack, header included */
+long rollback_Stack (Stack *, long); /* removes in constant time every
+                                   element pushed since the mark was taken
+                                   on this stack.  Marks nest, and a mark
+                                   of another stack, or one the stack has
+                                   since held fewer elements than, is
+                                   refused.  Result is 0 or non-0
+                                   indicating failure or success,
+                                   respectively */
+void set_allocator_Stack (void * (*) (size_t), void * (*) (void *, size_t),
+                          void (*) (void *)); /* sets the malloc, realloc
+                                   and free used for stack memory, NULL
+                                   restoring the default.  Only change it
+                                   while no stacks are allocated */
+long shrink_Stack (Stack **);   /* shrinks the stack to the number of
+                                   elements it holds, freeing memory unless
+                                   a pooled stack stays in its size class.
+                                   Incoming pointer is updated.  Result is
+                                   0 or non-0 indicating failure or success,
+                                   respectively */
 long top (Stack *, long *);     /* sends back the top element of the stack.
                                    Stack is left unaffected. Result is 0
                                    or non-0 indicating failure or success,
                                    respectively. */
+long top_n (Stack *, long *, unsigned long); /* sends back up to the given
+                                   number of elements from the top of the
+                                   stack in stack order, like pop_n.  Stack
+                                   is left unaffected.  Result is the number
+                                   of elements copied, 0 on failure */
 FILE * write_Stack (Stack *, FILE *); /* prints out the contents of the stack
                                    to the parameter specified FILE */
 
-void debug_on (void);     /* turns stack debugging on */
+void debug_on (void);     /* turns stack debugging on, recording every
+                             operation in the trace (trace.h) */
 void debug_off (void);    /* turns stack debugging off */
+void secure_on (void);    /* turns zeroing of removed stack values on */
+void secure_off (void);   /* turns zeroing of removed stack values off */
+void pool_on (void);      /* turns recycling of stack memory on */
+void pool_off (void);     /* turns recycling of stack memory off */
+void pool_trim (void);    /* releases the memory the calling thread keeps
+                             for recycling */
 
 #endif
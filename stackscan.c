@@ -0,0 +1,588 @@
+/******************************************************************************
+
+File Name:      stackscan.c
+Description:    This program implements scans over the contents of a stack:
+                whether and how deep a value is on it, how often it occurs,
+                and the smallest, largest and sum of the elements.  Each scan
+                has a plain loop and, on x86-64, SSE2 and AVX2 versions that
+                handle two or four longs per instruction, and the best the
+                processor supports is picked the first time a scan is made.
+
+******************************************************************************/
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include "mylib.h"
+#include "stackscan.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/* catastrophic error messages */
+static const char INCOMING_NONEXIST[] =
+                        "Incoming parameter does not exist!!!\n";
+static const char SCAN_EMPTY[] = "Scanning an empty stack!!!\n";
+static const char SCAN_NONEXIST[] = "Scanning a non-existent stack!!!\n";
+
+/* The versions of the scans for one instruction set.  Each is given the
+ * elements and how many there are, and find gives the index of the value
+ * nearest the top, or -1. */
+typedef struct ScanOps
+{
+    long level;                                         /* SCAN_ level */
+    long (*count) (const long *, long, long);           /* count matches */
+    long (*find) (const long *, long, long);            /* last match */
+    void (*range) (const long *, long, long *, long *); /* min and max */
+    long (*sum) (const long *, long);                   /* sum */
+} ScanOps;
+
+static long count_scalar (const long * values, long count, long value);
+static long find_scalar (const long * values, long count, long value);
+static void range_scalar (const long * values, long count, long * min,
+                          long * max);
+static long sum_scalar (const long * values, long count);
+static const ScanOps * scan_ops (void);
+static long start_scan (Stack * this_Stack, const void * item);
+
+static const ScanOps scalar_ops = { SCAN_SCALAR, count_scalar, find_scalar,
+                                    range_scalar, sum_scalar };
+
+#if defined(__x86_64__)
+
+static long count_avx2 (const long * values, long count, long value);
+static long count_sse2 (const long * values, long count, long value);
+static long find_avx2 (const long * values, long count, long value);
+static long find_sse2 (const long * values, long count, long value);
+static void range_avx2 (const long * values, long count, long * min,
+                        long * max);
+static long sum_avx2 (const long * values, long count);
+static long sum_sse2 (const long * values, long count);
+
+static const ScanOps sse2_ops = { SCAN_SSE2, count_sse2, find_sse2,
+                                  range_scalar, sum_sse2 };
+static const ScanOps avx2_ops = { SCAN_AVX2, count_avx2, find_avx2,
+                                  range_avx2, sum_avx2 };
+
+#endif
+
+static _Atomic (const ScanOps *) ops = NULL;   /* scans in use, once chosen */
+static long limit = SCAN_AVX2;  /* highest level the scans may use */
+
+
+/* whether the value is on the stack */
+long contains_Stack (Stack * this_Stack, long value)
+{
+    return find_Stack (this_Stack, value) >= 0;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          count_Stack
+Purpose:                This function counts the elements equal to a value
+Description:            This function compares every element on the stack to
+                        the value, several at a time when the processor can
+Input:                  this_Stack: the stack being scanned
+                        value: the value being counted
+Result:                 The number of elements equal to value, or 0 if the
+                        stack does not exist and an error message is printed
+----------------------------------------------------------------------------*/
+long count_Stack (Stack * this_Stack, long value)
+{
+    long count = start_scan (this_Stack, &value);   /* elements on stack */
+
+    /* If statement is executed if the stack does not exist or is empty */
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    return scan_ops ()->count (this_Stack, count, value);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          find_Stack
+Purpose:                This function finds how deep a value is on the stack
+Description:            This function compares the elements to the value from
+                        the top of the stack down, several at a time when the
+                        processor can, and stops at the first match, so a
+                        value near the top is found without reading the rest
+Input:                  this_Stack: the stack being scanned
+                        value: the value being found
+Result:                 The number of elements above the value nearest the
+                        top, or -1 if the value is not on the stack or the
+                        stack does not exist and an error message is printed
+----------------------------------------------------------------------------*/
+long find_Stack (Stack * this_Stack, long value)
+{
+    long count = start_scan (this_Stack, &value);   /* elements on stack */
+    long index = 0;         /* index of the value */
+
+    /* If statement is executed if the stack does not exist or is empty */
+    if (count <= 0)
+    {
+        return -1;
+    }
+
+    index = scan_ops ()->find (this_Stack, count, value);
+
+    return index < 0 ? -1 : count - 1 - index;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          max_Stack
+Purpose:                This function finds the largest element on the stack
+Description:            This function compares every element on the stack,
+                        several at a time when the processor can
+Input:                  this_Stack: the stack being scanned
+                        item: the largest element
+Result:                 True if the stack has elements. False if the stack or
+                        item does not exist or the stack is empty and an
+                        error message is printed
+----------------------------------------------------------------------------*/
+long max_Stack (Stack * this_Stack, long * item)
+{
+    long count = start_scan (this_Stack, item);     /* elements on stack */
+    long min = 0;           /* smallest element, not sent back */
+
+    /* If statement is executed if the stack is empty */
+    if (count == 0)
+    {
+        writeline (SCAN_EMPTY, stderr);     /* error message printed */
+    }
+
+    /* If statement is executed if there is no element to send back */
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    scan_ops ()->range (this_Stack, count, &min, item);
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          min_Stack
+Purpose:                This function finds the smallest element on the stack
+Description:            This function compares every element on the stack,
+                        several at a time when the processor can
+Input:                  this_Stack: the stack being scanned
+                        item: the smallest element
+Result:                 True if the stack has elements. False if the stack or
+                        item does not exist or the stack is empty and an
+                        error message is printed
+----------------------------------------------------------------------------*/
+long min_Stack (Stack * this_Stack, long * item)
+{
+    long count = start_scan (this_Stack, item);     /* elements on stack */
+    long max = 0;           /* largest element, not sent back */
+
+    /* If statement is executed if the stack is empty */
+    if (count == 0)
+    {
+        writeline (SCAN_EMPTY, stderr);     /* error message printed */
+    }
+
+    /* If statement is executed if there is no element to send back */
+    if (count <= 0)
+    {
+        return 0;
+    }
+
+    scan_ops ()->range (this_Stack, count, item, &max);
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          scan_level_Stack
+Purpose:                This function limits the instructions scans may use
+Description:            This function stores the highest level the scans may
+                        use and makes the next scan choose again, so that the
+                        versions can be compared on one processor. It should
+                        not be called while other threads are scanning
+Input:                  level: SCAN_SCALAR, SCAN_SSE2 or SCAN_AVX2
+Result:                 The level the scans now use
+----------------------------------------------------------------------------*/
+long scan_level_Stack (long level)
+{
+    limit = level;
+    atomic_store_explicit (&ops, NULL, memory_order_relaxed);
+
+    return scan_ops ()->level;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          sum_Stack
+Purpose:                This function adds up the elements on the stack
+Description:            This function adds every element on the stack, several
+                        at a time when the processor can, in unsigned
+                        arithmetic so that an overflow wraps around
+Input:                  this_Stack: the stack being scanned
+                        item: the sum of the elements
+Result:                 True if the sum was made, 0 for an empty stack. False
+                        if the stack or item does not exist and an error
+                        message is printed
+----------------------------------------------------------------------------*/
+long sum_Stack (Stack * this_Stack, long * item)
+{
+    long count = start_scan (this_Stack, item);     /* elements on stack */
+
+    /* If statement is executed if the stack or item does not exist */
+    if (count < 0)
+    {
+        return 0;
+    }
+
+    *item = count ? scan_ops ()->sum (this_Stack, count) : 0;
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          scan_ops
+Purpose:                This function picks the versions of the scans
+Description:            This function returns the versions already picked, or
+                        on the first scan picks AVX2 if the processor has it,
+                        SSE2 on any other x86-64 processor and plain loops
+                        elsewhere, within the limit set by scan_level_Stack.
+                        Threads racing on the first scan pick the same
+Input:                  None
+Result:                 The versions of the scans to use
+----------------------------------------------------------------------------*/
+static const ScanOps * scan_ops (void)
+{
+    const ScanOps * chosen = atomic_load_explicit (&ops,
+                                                   memory_order_relaxed);
+
+    /* If statement is executed if the scans have been picked already */
+    if (chosen)
+    {
+        return chosen;
+    }
+
+    chosen = &scalar_ops;
+
+#if defined(__x86_64__)
+    if ( limit >= SCAN_AVX2 && __builtin_cpu_supports ("avx2") )
+    {
+        chosen = &avx2_ops;
+    }
+    else if (limit >= SCAN_SSE2)
+    {
+        chosen = &sse2_ops;
+    }
+#endif
+
+    atomic_store_explicit (&ops, chosen, memory_order_relaxed);
+
+    return chosen;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          start_scan
+Purpose:                This function checks the parameters of a scan
+Description:            This function checks that the stack and the item the
+                        result is sent back in exist
+Input:                  this_Stack: the stack being scanned
+                        item: where the result goes
+Result:                 The number of elements on the stack, or -1 if the
+                        stack or item does not exist and an error message is
+                        printed
+----------------------------------------------------------------------------*/
+static long start_scan (Stack * this_Stack, const void * item)
+{
+    /* If statement is executed if the stack is not yet set */
+    if (!this_Stack)
+    {
+        writeline (SCAN_NONEXIST, stderr);      /* error message printed */
+        return -1;
+    }
+
+    /* If statement is executed if the item is not yet set */
+    if (!item)
+    {
+        writeline (INCOMING_NONEXIST, stderr);  /* error message printed */
+        return -1;
+    }
+
+    return this_Stack[STACK_POINTER_INDEX] + 1;
+}
+
+
+/* Plain loops, used on any processor and for the ends of vector scans. */
+
+/* counts the values equal to value */
+static long count_scalar (const long * values, long count, long value)
+{
+    long matches = 0;       /* values equal so far */
+    long index = 0;         /* index into values */
+
+    for (index = 0; index < count; index++)
+    {
+        matches += values[index] == value;
+    }
+
+    return matches;
+}
+
+
+/* finds the last value equal to value */
+static long find_scalar (const long * values, long count, long value)
+{
+    long index = 0;         /* index into values */
+
+    for (index = count - 1; index >= 0; index--)
+    {
+        if (values[index] == value)
+        {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+
+/* finds the smallest and largest of at least one value */
+static void range_scalar (const long * values, long count, long * min,
+                          long * max)
+{
+    long index = 0;         /* index into values */
+
+    *min = *max = values[0];
+
+    for (index = 1; index < count; index++)
+    {
+        if (values[index] < *min)
+        {
+            *min = values[index];
+        }
+        if (values[index] > *max)
+        {
+            *max = values[index];
+        }
+    }
+}
+
+
+/* adds up the values, wrapping around on overflow */
+static long sum_scalar (const long * values, long count)
+{
+    unsigned long sum = 0;  /* sum so far */
+    long index = 0;         /* index into values */
+
+    for (index = 0; index < count; index++)
+    {
+        sum += values[index];
+    }
+
+    return sum;
+}
+
+
+#if defined(__x86_64__)
+
+/* SSE2 versions, two longs to a register.  SSE2 compares 32-bit lanes only,
+ * so two longs are equal where both halves compare equal. */
+
+/* compares two longs to the value, all ones in the lanes that match */
+static inline __m128i equal_sse2 (__m128i values, __m128i value)
+{
+    __m128i halves = _mm_cmpeq_epi32 (values, value);   /* equal halves */
+
+    return _mm_and_si128 (halves,
+                          _mm_shuffle_epi32 (halves, _MM_SHUFFLE (2,3,0,1)));
+}
+
+
+/* counts the values equal to value */
+static long count_sse2 (const long * values, long count, long value)
+{
+    __m128i wanted = _mm_set1_epi64x (value);   /* value in every lane */
+    __m128i matches = _mm_setzero_si128 ();     /* matches in each lane */
+    long index = 0;         /* index into values */
+
+    for (; index + 2 <= count; index += 2)
+    {
+        matches = _mm_sub_epi64 (matches, equal_sse2 (
+            _mm_loadu_si128 ((const __m128i *)(values + index)), wanted));
+    }
+
+    return _mm_cvtsi128_si64 (matches) +
+           _mm_cvtsi128_si64 (_mm_unpackhi_epi64 (matches, matches)) +
+           count_scalar (values + index, count - index, value);
+}
+
+
+/* finds the last value equal to value, working down from the end */
+static long find_sse2 (const long * values, long count, long value)
+{
+    __m128i wanted = _mm_set1_epi64x (value);   /* value in every lane */
+    long index = count;     /* values from index up have been checked */
+    int mask = 0;           /* one bit for each matching lane */
+
+    /* If statement is executed if an odd value at the end matches */
+    if ( (count & 1) && values[--index] == value )
+    {
+        return index;
+    }
+
+    while (index >= 2)
+    {
+        index -= 2;
+        mask = _mm_movemask_pd (_mm_castsi128_pd (equal_sse2 (
+            _mm_loadu_si128 ((const __m128i *)(values + index)), wanted)));
+
+        if (mask)
+        {
+            return index + (mask >> 1);
+        }
+    }
+
+    return -1;
+}
+
+
+/* adds up the values, wrapping around on overflow */
+static long sum_sse2 (const long * values, long count)
+{
+    __m128i sums = _mm_setzero_si128 ();    /* sum in each lane */
+    long index = 0;         /* index into values */
+
+    for (; index + 2 <= count; index += 2)
+    {
+        sums = _mm_add_epi64 (sums,
+                   _mm_loadu_si128 ((const __m128i *)(values + index)));
+    }
+
+    return (unsigned long)_mm_cvtsi128_si64 (sums) +
+           (unsigned long)_mm_cvtsi128_si64 (_mm_unpackhi_epi64 (sums, sums)) +
+           (unsigned long)sum_scalar (values + index, count - index);
+}
+
+
+/* AVX2 versions, four longs to a register, compiled for AVX2 whatever the
+ * rest of the program is compiled for and only called when the processor
+ * has it. */
+
+/* counts the values equal to value */
+__attribute__ ((target ("avx2")))
+static long count_avx2 (const long * values, long count, long value)
+{
+    __m256i wanted = _mm256_set1_epi64x (value);    /* value in every lane */
+    __m256i matches = _mm256_setzero_si256 ();      /* matches in each lane */
+    long lanes[4];          /* the lanes of matches */
+    long index = 0;         /* index into values */
+
+    for (; index + 4 <= count; index += 4)
+    {
+        matches = _mm256_sub_epi64 (matches, _mm256_cmpeq_epi64 (
+            _mm256_loadu_si256 ((const __m256i *)(values + index)), wanted));
+    }
+
+    _mm256_storeu_si256 ((__m256i *)lanes, matches);
+
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+           count_scalar (values + index, count - index, value);
+}
+
+
+/* finds the last value equal to value, working down from the end */
+__attribute__ ((target ("avx2")))
+static long find_avx2 (const long * values, long count, long value)
+{
+    __m256i wanted = _mm256_set1_epi64x (value);    /* value in every lane */
+    long index = count & ~3L;   /* values from index up are checked first */
+    long found = find_scalar (values + index, count - index, value);
+    int mask = 0;           /* one bit for each matching lane */
+
+    /* If statement is executed if one of the values past the last whole
+     * register matches */
+    if (found >= 0)
+    {
+        return index + found;
+    }
+
+    while (index >= 4)
+    {
+        index -= 4;
+        mask = _mm256_movemask_pd (_mm256_castsi256_pd (_mm256_cmpeq_epi64 (
+            _mm256_loadu_si256 ((const __m256i *)(values + index)), wanted)));
+
+        if (mask)
+        {
+            return index + 31 - __builtin_clz (mask);
+        }
+    }
+
+    return -1;
+}
+
+
+/* finds the smallest and largest of at least one value */
+__attribute__ ((target ("avx2")))
+static void range_avx2 (const long * values, long count, long * min,
+                        long * max)
+{
+    __m256i lows = _mm256_set1_epi64x (values[0]);  /* least in each lane */
+    __m256i highs = lows;   /* greatest in each lane */
+    __m256i next;           /* the next four values */
+    long lanes[8];          /* the lanes of lows and highs */
+    long low = 0;           /* least of some values */
+    long high = 0;          /* greatest of some values */
+    long index = 0;         /* index into values */
+
+    for (; index + 4 <= count; index += 4)
+    {
+        next = _mm256_loadu_si256 ((const __m256i *)(values + index));
+        lows = _mm256_blendv_epi8 (lows, next,
+                                   _mm256_cmpgt_epi64 (lows, next));
+        highs = _mm256_blendv_epi8 (highs, next,
+                                    _mm256_cmpgt_epi64 (next, highs));
+    }
+
+    _mm256_storeu_si256 ((__m256i *)lanes, lows);
+    _mm256_storeu_si256 ((__m256i *)(lanes + 4), highs);
+    range_scalar (lanes, 4, min, &high);
+    range_scalar (lanes + 4, 4, &low, max);
+
+    /* If statement is executed if values are left past the last register */
+    if (index < count)
+    {
+        range_scalar (values + index, count - index, &low, &high);
+        *min = low < *min ? low : *min;
+        *max = high > *max ? high : *max;
+    }
+}
+
+
+/* adds up the values, wrapping around on overflow */
+__attribute__ ((target ("avx2")))
+static long sum_avx2 (const long * values, long count)
+{
+    __m256i sums = _mm256_setzero_si256 ();     /* sum in each lane */
+    unsigned long lanes[4];     /* the lanes of sums */
+    long index = 0;             /* index into values */
+
+    for (; index + 4 <= count; index += 4)
+    {
+        sums = _mm256_add_epi64 (sums,
+                   _mm256_loadu_si256 ((const __m256i *)(values + index)));
+    }
+
+    _mm256_storeu_si256 ((__m256i *)lanes, sums);
+
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+           (unsigned long)sum_scalar (values + index, count - index);
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef STACKSCAN_H
+#define STACKSCAN_H
+
+#include "stack.h"
+
+/* Stack scans answer questions about every element of a stack at once,
+reading the array from index 0 to the stack pointer in place and leaving
+the stack unaffected.  On x86-64 the scans compare and add several longs
+per instruction with AVX2 when the processor has it, or SSE2 otherwise,
+the choice being made once at the first scan.  Other processors use plain
+loops, and so do min and max where SSE2 has no 64-bit comparison. */
+
+#define SCAN_SCALAR 0           /* scans use plain loops */
+#define SCAN_SSE2 1             /* scans use SSE2 where they can */
+#define SCAN_AVX2 2             /* scans use AVX2 */
+
+long contains_Stack (Stack *, long); /* returns 0 or non-0 value indicating
+                                   whether or not the value is on the
+                                   stack */
+long count_Stack (Stack *, long); /* returns the number of elements of the
+                                   stack equal to the value */
+long find_Stack (Stack *, long); /* returns the depth of the value nearest
+                                   the top of the stack, 0 being the top,
+                                   or -1 if it is not on the stack */
+long max_Stack (Stack *, long *); /* sends back the largest element of the
+                                   stack.  Result is 0 or non-0 indicating
+                                   failure or success, respectively */
+long min_Stack (Stack *, long *); /* sends back the smallest element of the
+                                   stack.  Result is 0 or non-0 indicating
+                                   failure or success, respectively */
+long scan_level_Stack (long);   /* limits the scans to SCAN_SCALAR,
+                                   SCAN_SSE2 or SCAN_AVX2, for comparing
+                                   them.  Result is the level now used,
+                                   which the processor may hold lower */
+long sum_Stack (Stack *, long *); /* sends back the sum of the elements of
+                                   the stack, wrapping around on overflow.
+                                   Result is 0 or non-0 indicating failure
+                                   or success, respectively */
+
+#endif
@@ -0,0 +1,205 @@
+/******************************************************************************
+
+File Name:      stats.c
+Description:    This program implements the stack statistics: the blocks of
+                counters each thread keeps, the snapshot that adds them up
+                for the whole process and the function that reads the
+                counters kept in the header of one stack.
+
+******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mylib.h"
+#include "stats.h"
+
+/* catastrophic error messages */
+static const char STATS_NONEXIST[] = "Statistics of a non-existent stack!!!\n";
+#ifndef STACK_NO_STATS
+static const char WATCH_FAILED[] = "Watching a stack failed!!!\n";
+#endif
+static const char WATCH_NONEXIST[] = "Watching a non-existent stack!!!\n";
+
+static _Atomic (StatsBlock *) blocks = NULL;   /* every block ever made */
+_Thread_local StatsBlock * stats_block = NULL; /* this thread's block */
+
+
+/*----------------------------------------------------------------------------
+Function Name:          stats_register
+Purpose:                This function makes the calling thread's counters
+Description:            This function allocates a zeroed block of counters,
+                        links it into the list of blocks with a
+                        compare-and-swap and keeps it as the thread's block.
+                        Blocks are never freed, so the counts of threads that
+                        have finished stay in the snapshot
+Input:                  None
+Result:                 The thread's block, or NULL if it could not be
+                        allocated, in which case the thread's events are not
+                        counted
+----------------------------------------------------------------------------*/
+StatsBlock * stats_register (void) 
+{
+    StatsBlock * block = calloc (1, sizeof(StatsBlock));   /* new block */
+
+    /* If statement is executed if the block could not be allocated */
+    if (!block)
+    {
+        return NULL;
+    }
+
+    block->next = atomic_load_explicit (&blocks, memory_order_relaxed);
+    while ( !atomic_compare_exchange_weak_explicit (&blocks, &block->next,
+                block, memory_order_release, memory_order_relaxed) )
+    {
+    }
+
+    stats_block = block;
+
+    return block;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          stats_snapshot
+Purpose:                This function reports the statistics of the process
+Description:            This function walks the list of blocks, adding up
+                        each counter and keeping the deepest stack any thread
+                        has seen. Counters are read with relaxed loads while
+                        other threads go on counting, so each figure is exact
+                        for some moment during the walk rather than for one
+                        instant
+Input:                  stats: the figures being filled in
+Result:                 The figures for every thread, all 0 when statistics
+                        are compiled out
+----------------------------------------------------------------------------*/
+void stats_snapshot (StackStats * stats) 
+{
+    StatsBlock * current = 0;       /* block being added */
+    long totals[STATS_COUNTERS];    /* counters added up so far */
+    long value = 0;                 /* counter being added */
+    long counter = 0;               /* index of that counter */
+
+    memset (totals, 0, sizeof(totals));
+
+    for (current = atomic_load_explicit (&blocks, memory_order_acquire);
+         current; current = current->next)
+    {
+        for (counter = 0; counter < STATS_COUNTERS; counter++)
+        {
+            value = atomic_load_explicit (&current->counters[counter],
+                                          memory_order_relaxed);
+
+            /* If statement is executed for the one counter that is the
+             * largest over the threads rather than their sum */
+            if (counter == STATS_MAX_DEPTH)
+            {
+                if (value > totals[counter])
+                {
+                    totals[counter] = value;
+                }
+            }
+            else
+            {
+                totals[counter] += value;
+            }
+        }
+    }
+
+    stats->pushes = totals[STATS_PUSHES];
+    stats->pops = totals[STATS_POPS];
+    stats->tops = totals[STATS_TOPS];
+    stats->push_full = totals[STATS_PUSH_FULL];
+    stats->pop_empty = totals[STATS_POP_EMPTY];
+    stats->top_empty = totals[STATS_TOP_EMPTY];
+    stats->max_depth = totals[STATS_MAX_DEPTH];
+    stats->size = 0;
+    stats->reserved = totals[STATS_RESERVED];
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          stats_Stack
+Purpose:                This function reports the statistics of one stack
+Description:            This function copies the counters out of the block
+                        a watched stack keeps beside it and asks
+                        reserved_Stack for the bytes its block reserves
+Input:                  this_Stack: the stack being reported
+                        stats: the figures being filled in
+Result:                 True if the figures were filled in, the counters
+                        being 0 when the stack is not watched or statistics
+                        are compiled out. False if the stack or figures do
+                        not exist and an error message is printed
+----------------------------------------------------------------------------*/
+long stats_Stack (Stack * this_Stack, StackStats * stats) 
+{
+    /* If statement is executed if the stack or figures do not exist */
+    if (!this_Stack || !stats)
+    {
+        writeline (STATS_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+    memset (stats, 0, sizeof(StackStats));
+
+#ifndef STACK_NO_STATS
+    /* If statement is executed if the stack keeps counters of its own */
+    if ( STATS_OF (this_Stack) )
+    {
+        stats->pushes = STATS_OF (this_Stack)[STATS_PUSHES];
+        stats->pops = STATS_OF (this_Stack)[STATS_POPS];
+        stats->tops = STATS_OF (this_Stack)[STATS_TOPS];
+        stats->push_full = STATS_OF (this_Stack)[STATS_PUSH_FULL];
+        stats->pop_empty = STATS_OF (this_Stack)[STATS_POP_EMPTY];
+        stats->top_empty = STATS_OF (this_Stack)[STATS_TOP_EMPTY];
+        stats->max_depth = STATS_OF (this_Stack)[STATS_MAX_DEPTH];
+    }
+#endif
+
+    stats->size = this_Stack[STACK_SIZE_INDEX];
+    stats->reserved = reserved_Stack (this_Stack);
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          stats_watch
+Purpose:                This function starts counting the events of one stack
+Description:            This function allocates a zeroed block of counters
+                        and points the STACK_STATS_INDEX slot of the stack's
+                        header at it, so that every later event on the stack
+                        is also counted there. detach_Stack frees the block.
+                        When statistics are compiled out nothing is kept
+Input:                  this_Stack: the stack to be watched
+Result:                 True if the stack is watched or already was. False
+                        if the stack does not exist or the block could not
+                        be allocated and an error message is printed
+----------------------------------------------------------------------------*/
+long stats_watch (Stack * this_Stack) 
+{
+    /* If statement is executed if the stack does not exist */
+    if (!this_Stack)
+    {
+        writeline (WATCH_NONEXIST, stderr);    /* error message printed */
+        return 0;
+    }
+
+#ifndef STACK_NO_STATS
+    /* If statement is executed if the stack is not yet watched */
+    if ( !STATS_OF (this_Stack) )
+    {
+        this_Stack[STACK_STATS_INDEX] = 
+            (long)calloc (STATS_COUNTERS, sizeof(long));
+
+        /* If statement is executed if the block could not be allocated */
+        if ( !STATS_OF (this_Stack) )
+        {
+            writeline (WATCH_FAILED, stderr);  /* error message printed */
+            return 0;
+        }
+    }
+#endif
+
+    return 1;
+}
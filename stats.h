@@ -0,0 +1,145 @@
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include "stack.h"
+
+/* Stack statistics count the operations made on stacks, the ones that
+failed and why, the deepest each stack has been and the memory stacks
+reserve.  Every thread adds events to a block of counters of its own,
+which no other thread writes, so the process-wide figures cost no locked
+instruction; stats_snapshot adds the blocks up.  A stack given to
+stats_watch also keeps counters of its own, in a block beside the stack
+that its STACK_STATS_INDEX header slot points to, updated with plain
+stores by the thread using the stack.  Other stacks pay one test of that
+slot per operation and carry no counters, so small stacks stay small.
+
+Compiling with STACK_NO_STATS defined turns every STATS_ macro into
+nothing, so statistics cost nothing at all.  The header slot stays, unused,
+so stacks built either way have the same layout. */
+
+/* counters, both per stack and per thread */
+#define STATS_PUSHES 0          /* values pushed */
+#define STATS_POPS 1            /* values popped */
+#define STATS_TOPS 2            /* values topped */
+#define STATS_PUSH_FULL 3       /* pushes refused by a full stack */
+#define STATS_POP_EMPTY 4       /* pops refused by an empty stack */
+#define STATS_TOP_EMPTY 5       /* tops refused by an empty stack */
+#define STATS_MAX_DEPTH 6       /* most elements a stack has held */
+#define STATS_RESERVED 7        /* bytes reserved, per thread only */
+#define STATS_COUNTERS 8        /* number of counters */
+
+typedef struct StackStats
+{
+    long pushes;            /* values pushed */
+    long pops;              /* values popped */
+    long tops;              /* values topped */
+    long push_full;         /* pushes refused by a full stack */
+    long pop_empty;         /* pops refused by an empty stack */
+    long top_empty;         /* tops refused by an empty stack */
+    long max_depth;         /* most elements held at once */
+    long size;              /* elements the stack can hold */
+    long reserved;          /* bytes of memory reserved */
+} StackStats;
+
+/* One thread's counters, linked into the list stats_snapshot walks. */
+typedef struct StatsBlock
+{
+    struct StatsBlock * next;               /* next block in the list */
+    _Atomic long counters[STATS_COUNTERS];  /* written by one thread only */
+} StatsBlock;
+
+extern _Thread_local StatsBlock * stats_block;  /* this thread's counters */
+
+StatsBlock * stats_register (void); /* makes the calling thread's block */
+void stats_snapshot (StackStats *); /* fills in the process-wide figures:
+                                       counters added up over every thread,
+                                       max_depth the deepest any stack has
+                                       been, reserved the bytes live stacks
+                                       hold, size 0 */
+long stats_Stack (Stack *, StackStats *); /* fills in the figures of one
+                                       stack, the counters being 0 unless
+                                       it is watched.  Result is 0 or non-0
+                                       indicating failure or success,
+                                       respectively */
+long stats_watch (Stack *);         /* starts keeping the stack's own
+                                       counters, until it is deleted.
+                                       Result is 0 or non-0 indicating
+                                       failure or success, respectively */
+
+#ifdef STACK_NO_STATS
+
+#define STATS_ADD(this_Stack, counter, amount)
+#define STATS_DEPTH(this_Stack)
+#define STATS_RELEASE(this_Stack)
+#define STATS_RESERVE(bytes)
+
+#else
+
+/* adds amount to one of the calling thread's counters, a relaxed load and
+ * store being enough since no other thread writes it */
+static inline void stats_add (int counter, long amount)
+{
+    StatsBlock * block = stats_block ? stats_block : stats_register ();
+
+    /* If statement is executed if the block could be made */
+    if (block)
+    {
+        atomic_store_explicit (&block->counters[counter],
+            atomic_load_explicit (&block->counters[counter],
+                                  memory_order_relaxed) + amount,
+            memory_order_relaxed);
+    }
+}
+
+/* raises the calling thread's deepest stack to depth */
+static inline void stats_depth (long depth)
+{
+    StatsBlock * block = stats_block ? stats_block : stats_register ();
+
+    /* If statement is executed if the block could be made and is beaten */
+    if ( block && depth > atomic_load_explicit (
+                    &block->counters[STATS_MAX_DEPTH], memory_order_relaxed) )
+    {
+        atomic_store_explicit (&block->counters[STATS_MAX_DEPTH], depth,
+                               memory_order_relaxed);
+    }
+}
+
+/* the counters of a watched stack, or NULL */
+#define STATS_OF(this_Stack) ( (long *)(this_Stack)[STACK_STATS_INDEX] )
+
+/* counts an event on a watched stack and on the calling thread */
+#define STATS_ADD(this_Stack, counter, amount) \
+    ( STATS_OF (this_Stack) ? \
+          (void)(STATS_OF (this_Stack)[counter] += (amount)) : (void)0, \
+      stats_add ((counter), (amount)) )
+
+/* records a new deepest point of a stack after values were pushed, for the
+ * thread and for the stack when it is watched */
+#define STATS_DEPTH(this_Stack) \
+    do { \
+        stats_depth ((this_Stack)[STACK_POINTER_INDEX] + 1); \
+        if ( STATS_OF (this_Stack) && \
+             (this_Stack)[STACK_POINTER_INDEX] >= \
+             STATS_OF (this_Stack)[STATS_MAX_DEPTH] ) \
+        { \
+            STATS_OF (this_Stack)[STATS_MAX_DEPTH] = \
+                (this_Stack)[STACK_POINTER_INDEX] + 1; \
+        } \
+    } while (0)
+
+/* frees the counters of a watched stack */
+#define STATS_RELEASE(this_Stack) \
+    do { \
+        free (STATS_OF (this_Stack)); \
+        (this_Stack)[STACK_STATS_INDEX] = 0; \
+    } while (0)
+
+/* counts bytes of stack memory reserved, or given back when negative */
+#define STATS_RESERVE(bytes) stats_add (STATS_RESERVED, (bytes))
+
+#endif
+
+#endif
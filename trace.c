@@ -0,0 +1,287 @@
+/******************************************************************************
+
+File Name:      trace.c
+Description:    This program implements the stack trace: per-thread ring
+                buffers of operation records that are filled without locks,
+                and the functions that drain them and print them as the
+                stack debug messages.
+
+******************************************************************************/
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "mylib.h"
+#include "trace.h"
+
+#define TRACE_RING 4096         /* records in each ring, a power of two */
+
+/* Debug messages, the formats trace_dump prints records in. */
+static const char ALLOCATED[] = "[Stack %ld has been allocated]\n";
+static const char DEALLOCATE[] = "[Stack %ld has been deallocated]\n";
+static const char POP[] = "[Stack %ld - Popping %ld]\n";
+static const char PUSH[] = "[Stack %ld - Pushing %ld]\n";
+static const char TOP[] = "[Stack %ld - Topping %ld]\n";
+
+/* One thread's records.  The thread writes at head and the drainer reads
+ * at tail, each publishing its progress with a release store.  A ring whose
+ * thread has exited is no longer owned and may be taken by a new thread
+ * once it has been drained. */
+typedef struct TraceRing 
+{
+    struct TraceRing * next;            /* next ring in the list of rings */
+    _Atomic int owned;                  /* whether a thread writes it */
+    _Atomic unsigned long head;         /* records written so far */
+    _Atomic unsigned long tail;         /* records drained so far */
+    _Atomic long dropped;               /* records lost to a full ring */
+    TraceRecord records[TRACE_RING];    /* the ring itself */
+} TraceRing;
+
+_Atomic int trace_enabled = FALSE;  /* allocation of trace flag */
+
+static _Atomic (TraceRing *) rings = NULL;  /* every ring ever made */
+static _Thread_local TraceRing * ring = NULL;   /* this thread's ring */
+static pthread_key_t ring_key;          /* gives up a ring at thread exit */
+static pthread_once_t ring_once = PTHREAD_ONCE_INIT; /* makes ring_key */
+
+static TraceRing * get_ring (void);
+static void make_key (void);
+static void print_record (const TraceRecord * record, void * stream);
+static void put_ring (void * old_ring);
+
+
+/* Trace state methods */
+void trace_off (void) 
+{
+        atomic_store_explicit (&trace_enabled, FALSE, memory_order_relaxed);
+}
+
+
+void trace_on (void) 
+{
+        atomic_store_explicit (&trace_enabled, TRUE, memory_order_relaxed);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          trace_drain
+Purpose:                This function empties the rings of every thread
+Description:            This function walks the list of rings. For each ring
+                        it reads the head the owning thread has published,
+                        passes the records from the tail up to it to the
+                        callback and then publishes the new tail, which lets
+                        the owner reuse those slots
+Input:                  callback: function given each record
+                        argument: pointer passed along to the callback
+Result:                 The number of records drained
+----------------------------------------------------------------------------*/
+long trace_drain (void (*callback) (const TraceRecord *, void *), 
+                  void * argument) 
+{
+    TraceRing * current = 0;    /* ring being drained */
+    unsigned long head = 0;     /* records written to the ring */
+    unsigned long tail = 0;     /* records drained from the ring */
+    long drained = 0;           /* records passed to the callback */
+
+    for (current = atomic_load_explicit (&rings, memory_order_acquire);
+         current; current = current->next)
+    {
+        head = atomic_load_explicit (&current->head, memory_order_acquire);
+        tail = atomic_load_explicit (&current->tail, memory_order_relaxed);
+
+        for (; tail != head; tail++, drained++)
+        {
+            callback (&current->records[tail & (TRACE_RING - 1)], argument);
+        }
+
+        atomic_store_explicit (&current->tail, tail, memory_order_release);
+    }
+
+    return drained;
+}
+
+
+/* drains the trace through the debug message formatter */
+long trace_dump (FILE * stream) 
+{
+    return trace_drain (print_record, stream);
+}
+
+
+/* adds up the records every ring has dropped */
+long trace_dropped (void) 
+{
+    TraceRing * current = 0;    /* ring being counted */
+    long dropped = 0;           /* records dropped so far */
+
+    for (current = atomic_load_explicit (&rings, memory_order_acquire);
+         current; current = current->next)
+    {
+        dropped += atomic_load_explicit (&current->dropped, 
+                                         memory_order_relaxed);
+    }
+
+    return dropped;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          trace_record
+Purpose:                This function records one stack operation
+Description:            This function finds the calling thread's ring,
+                        getting one from get_ring the first time. If the
+                        drainer has not yet freed a slot, the record is
+                        dropped and counted. Otherwise it is stored with the
+                        time and the new head is published
+Input:                  op: which TRACE_ operation was made
+                        stack: which stack it was made on
+                        value: the value pushed, popped or topped
+Result:                 The operation is recorded or counted as dropped
+----------------------------------------------------------------------------*/
+void trace_record (long op, long stack, long value) 
+{
+    TraceRecord * record = 0;   /* slot the record goes in */
+    struct timespec now;        /* time of the operation */
+    unsigned long head = 0;     /* records written to the ring */
+
+    /* If statement is executed the first time this thread records */
+    if ( !ring && !(ring = get_ring ()) )
+    {
+        return;
+    }
+
+    head = atomic_load_explicit (&ring->head, memory_order_relaxed);
+
+    /* If statement is executed if the ring is full */
+    if (head - atomic_load_explicit (&ring->tail, memory_order_acquire) 
+        >= TRACE_RING)
+    {
+        atomic_store_explicit (&ring->dropped, 
+            atomic_load_explicit (&ring->dropped, memory_order_relaxed) + 1,
+            memory_order_relaxed);
+        return;
+    }
+
+    clock_gettime (CLOCK_MONOTONIC, &now);
+
+    record = &ring->records[head & (TRACE_RING - 1)];
+    record->op = op;
+    record->stack = stack;
+    record->value = value;
+    record->time = now.tv_sec * 1000000000L + now.tv_nsec;
+
+    atomic_store_explicit (&ring->head, head + 1, memory_order_release);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          get_ring
+Purpose:                This function finds a ring for the calling thread
+Description:            This function takes the first ring in the list whose
+                        thread has exited and which has been drained,
+                        claiming it with a compare-and-swap on its owned
+                        flag. If there is none, a ring is made and linked
+                        into the list with a compare-and-swap. Either way
+                        the ring is set as the thread's value of ring_key,
+                        so that put_ring gives it up when the thread exits
+Input:                  None
+Result:                 The thread's ring, or NULL if none was free and one
+                        could not be allocated, in which case the record is
+                        not made
+----------------------------------------------------------------------------*/
+static TraceRing * get_ring (void) 
+{
+    TraceRing * current = 0;    /* ring being tried */
+    int owned = FALSE;          /* owned flag expected on a free ring */
+
+    pthread_once (&ring_once, make_key);
+
+    for (current = atomic_load_explicit (&rings, memory_order_acquire);
+         current; current = current->next)
+    {
+        owned = FALSE;
+
+        /* If statement is executed if the ring is drained and this thread
+         * takes it, the acquire pairing with put_ring's release */
+        if ( !atomic_load_explicit (&current->owned, memory_order_relaxed) &&
+             atomic_load_explicit (&current->tail, memory_order_acquire) ==
+             atomic_load_explicit (&current->head, memory_order_relaxed) &&
+             atomic_compare_exchange_strong_explicit (&current->owned,
+                 &owned, TRUE, memory_order_acquire, memory_order_relaxed) )
+        {
+            break;
+        }
+    }
+
+    /* If statement is executed if no ring was free, when one is made */
+    if (!current)
+    {
+        current = calloc (1, sizeof(TraceRing));
+
+        /* If statement is executed if the ring could not be allocated */
+        if (!current)
+        {
+            return NULL;
+        }
+
+        atomic_init (&current->owned, TRUE);
+        current->next = atomic_load_explicit (&rings, memory_order_relaxed);
+        while ( !atomic_compare_exchange_weak_explicit (&rings, 
+                    &current->next, current, memory_order_release, 
+                    memory_order_relaxed) )
+        {
+        }
+    }
+
+    pthread_setspecific (ring_key, current);
+
+    return current;
+}
+
+
+/* makes the key whose destructor gives up a ring when its thread exits */
+static void make_key (void) 
+{
+    pthread_key_create (&ring_key, put_ring);
+}
+
+
+/* prints one record as a stack debug message */
+static void print_record (const TraceRecord * record, void * stream) 
+{
+    switch (record->op)
+    {
+        case TRACE_ALLOCATE:
+            fprintf (stream, ALLOCATED, record->stack);
+            break;
+
+        case TRACE_DEALLOCATE:
+            fprintf (stream, DEALLOCATE, record->stack);
+            break;
+
+        case TRACE_POP:
+            fprintf (stream, POP, record->stack, record->value);
+            break;
+
+        case TRACE_PUSH:
+            fprintf (stream, PUSH, record->stack, record->value);
+            break;
+
+        case TRACE_TOP:
+            fprintf (stream, TOP, record->stack, record->value);
+            break;
+    }
+}
+
+
+/* gives up the ring of an exiting thread, its last records being published
+ * before the ring may be taken */
+static void put_ring (void * old_ring) 
+{
+    TraceRing * current = old_ring;     /* the thread's ring */
+
+    ring = NULL;
+    atomic_store_explicit (&current->owned, FALSE, memory_order_release);
+}
@@ -0,0 +1,61 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdatomic.h>
+#include <stdio.h>
+
+/* Stack tracing records every traced operation as a small binary record in
+a ring buffer belonging to the thread that made it, instead of printing it.
+Recording takes no lock: each ring has one writer, its thread, and one
+reader, whoever drains the trace.  trace_drain hands the records to a
+callback and trace_dump is the formatter that prints them as the stack
+debug messages.  A full ring drops new records and counts them.  The ring
+of a thread that has exited is given to the next new thread to record once
+its records have been drained, so threads coming and going do not make
+rings without end.
+
+Compiling with STACK_NO_TRACE defined turns TRACING into 0, so every
+"if (TRACING)" test, and the code it guards, is removed by the compiler. */
+
+/* traced operations */
+#define TRACE_ALLOCATE 1        /* a stack was allocated */
+#define TRACE_DEALLOCATE 2      /* a stack was deallocated */
+#define TRACE_POP 3             /* a value was popped */
+#define TRACE_PUSH 4            /* a value was pushed */
+#define TRACE_TOP 5             /* a value was topped */
+
+#ifdef STACK_NO_TRACE
+#define TRACING 0
+#else
+#define TRACING atomic_load_explicit (&trace_enabled, memory_order_relaxed)
+#endif
+
+typedef struct TraceRecord 
+{
+    long op;                    /* which TRACE_ operation */
+    long stack;                 /* which stack it was made on */
+    long value;                 /* value pushed, popped or topped */
+    long time;                  /* monotonic time in nanoseconds */
+} TraceRecord;
+
+extern _Atomic int trace_enabled; /* whether operations are being
+                                   recorded */
+
+long trace_drain (void (*) (const TraceRecord *, void *), void *); /* passes
+                                   every recorded operation, oldest first
+                                   for each thread, to the function along
+                                   with the pointer, and removes it.  Only
+                                   one thread may drain at a time.  Result
+                                   is the number of records drained */
+long trace_dump (FILE *);       /* drains the trace, printing each record
+                                   as a stack debug message to the FILE.
+                                   Result is the number of records printed */
+long trace_dropped (void);      /* returns the number of records dropped
+                                   because a ring was full */
+void trace_off (void);          /* turns recording of operations off */
+void trace_on (void);           /* turns recording of operations on */
+void trace_record (long, long, long); /* records an operation, the stack it
+                                   was made on and its value in the calling
+                                   thread's ring */
+
+#endif
@@ -0,0 +1,16 @@
+/******************************************************************************
+
+File Name:      typedstack.c
+Description:    This program defines the typed stacks declared in
+                typedstack.h for 32-bit and 64-bit integers, doubles and
+                pointers.  Stacks of other types are defined the same way
+                with DEFINE_TYPED_STACK.
+
+******************************************************************************/
+
+#include "typedstack.h"
+
+DEFINE_TYPED_STACK (Int32Stack, int32_t)
+DEFINE_TYPED_STACK (Int64Stack, int64_t)
+DEFINE_TYPED_STACK (DoubleStack, double)
+DEFINE_TYPED_STACK (PtrStack, void *)
@@ -0,0 +1,189 @@
+#ifndef TYPEDSTACK_H
+#define TYPEDSTACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mylib.h"
+
+/* Typed stacks hold elements of any one type instead of longs, so a stack
+of 32-bit ids takes half the memory and bandwidth of a Stack.  They follow
+the same design as stack.h: the caller holds a pointer to the first element
+of an array, and the stack size and stack pointer are kept in a header just
+below it.  The header is padded so the elements keep the alignment of their
+type.
+
+DECLARE_TYPED_STACK (name, type) declares a stack type called name and its
+functions, normally in a header, and DEFINE_TYPED_STACK (name, type) defines
+the functions, in exactly one source file.  For example,
+DECLARE_TYPED_STACK (PointStack, struct point) gives:
+
+    typedef struct point PointStack;
+    void delete_PointStack (PointStack **);
+    void empty_PointStack (PointStack *);
+    long isempty_PointStack (PointStack *);
+    long isfull_PointStack (PointStack *);
+    PointStack * new_PointStack (unsigned long);
+    long num_elements_PointStack (PointStack *);
+    long pop_PointStack (PointStack *, struct point *);
+    long push_PointStack (PointStack *, struct point);
+    long top_PointStack (PointStack *, struct point *);
+
+Each works like the Stack function of the same name, except that push does
+not treat any value as EOF.  Stacks for int32_t, int64_t, double and
+pointers are declared below and defined in typedstack.c. */
+
+typedef struct TypedStackHeader
+{
+    long size;                  /* number of elements the stack can hold */
+    long pointer;               /* index of last used space */
+} TypedStackHeader;
+
+/* bytes from the start of the allocation to the first element */
+#define TYPED_STACK_OFFSET(type) \
+    ( (sizeof(TypedStackHeader) + _Alignof (type) - 1) / _Alignof (type) \
+      * _Alignof (type) )
+
+/* alignment of the allocation, at least that of malloc */
+#define TYPED_STACK_ALIGN(type) \
+    ( _Alignof (type) > _Alignof (max_align_t) ? \
+      _Alignof (type) : _Alignof (max_align_t) )
+
+/* the header, just below the first element */
+#define TYPED_STACK_HEADER(this_Stack) \
+    ( (TypedStackHeader *)(void *)(this_Stack) - 1 )
+
+#define DECLARE_TYPED_STACK(name, type) \
+    typedef type name; \
+    void delete_##name (name **); \
+    void empty_##name (name *); \
+    long isempty_##name (name *); \
+    long isfull_##name (name *); \
+    name * new_##name (unsigned long); \
+    long num_elements_##name (name *); \
+    long pop_##name (name *, type *); \
+    long push_##name (name *, type); \
+    long top_##name (name *, type *);
+
+#define DEFINE_TYPED_STACK(name, type) \
+    void delete_##name (name ** spp) \
+    { \
+        if (!spp || !*spp) \
+        { \
+            writeline ("Deleting a non-existent stack!!!\n", stderr); \
+            return; \
+        } \
+        free ( (char *)*spp - TYPED_STACK_OFFSET (type) ); \
+        *spp = NULL; \
+    } \
+    \
+    void empty_##name (name * this_Stack) \
+    { \
+        if (!this_Stack) \
+        { \
+            writeline ("Emptying a non-existent stack!!!\n", stderr); \
+            return; \
+        } \
+        TYPED_STACK_HEADER (this_Stack)->pointer = -1; \
+    } \
+    \
+    long isempty_##name (name * this_Stack) \
+    { \
+        if (!this_Stack) \
+        { \
+            writeline ("Isempty check from a non-existent stack!!!\n", \
+                       stderr); \
+            return 1; \
+        } \
+        return TYPED_STACK_HEADER (this_Stack)->pointer == -1; \
+    } \
+    \
+    long isfull_##name (name * this_Stack) \
+    { \
+        if (!this_Stack) \
+        { \
+            writeline ("Isfull check from a non-existent stack!!!\n", \
+                       stderr); \
+            return 0; \
+        } \
+        return TYPED_STACK_HEADER (this_Stack)->pointer >= \
+               TYPED_STACK_HEADER (this_Stack)->size - 1; \
+    } \
+    \
+    name * new_##name (unsigned long stacksize) \
+    { \
+        char * memory = 0; \
+        name * this_Stack = 0; \
+        if ( stacksize > ((size_t)-1 - TYPED_STACK_OFFSET (type) - \
+                          TYPED_STACK_ALIGN (type)) / sizeof(type) || \
+             !(memory = aligned_alloc (TYPED_STACK_ALIGN (type), \
+                  (TYPED_STACK_OFFSET (type) + stacksize * sizeof(type) + \
+                   TYPED_STACK_ALIGN (type) - 1) / TYPED_STACK_ALIGN (type) \
+                  * TYPED_STACK_ALIGN (type))) ) \
+        { \
+            writeline ("Allocating a stack failed!!!\n", stderr); \
+            return NULL; \
+        } \
+        this_Stack = (name *)(void *)(memory + TYPED_STACK_OFFSET (type)); \
+        TYPED_STACK_HEADER (this_Stack)->size = stacksize; \
+        TYPED_STACK_HEADER (this_Stack)->pointer = -1; \
+        return this_Stack; \
+    } \
+    \
+    long num_elements_##name (name * this_Stack) \
+    { \
+        if (!this_Stack) \
+        { \
+            writeline ("Num_elements check from a non-existent stack!!!\n", \
+                       stderr); \
+            return 0; \
+        } \
+        return TYPED_STACK_HEADER (this_Stack)->pointer + 1; \
+    } \
+    \
+    long pop_##name (name * this_Stack, type * item) \
+    { \
+        if (!this_Stack || TYPED_STACK_HEADER (this_Stack)->pointer <= -1) \
+        { \
+            writeline ("Popping from a non-existent stack!!!\n", stderr); \
+            return 0; \
+        } \
+        *item = this_Stack[TYPED_STACK_HEADER (this_Stack)->pointer--]; \
+        return 1; \
+    } \
+    \
+    long push_##name (name * this_Stack, type item) \
+    { \
+        if (!this_Stack) \
+        { \
+            writeline ("Pushing to a non-existent stack!!!\n", stderr); \
+            return 0; \
+        } \
+        if ( isfull_##name (this_Stack) ) \
+        { \
+            writeline ("Pushing to a full stack!!!\n", stderr); \
+            return 0; \
+        } \
+        this_Stack[++TYPED_STACK_HEADER (this_Stack)->pointer] = item; \
+        return 1; \
+    } \
+    \
+    long top_##name (name * this_Stack, type * item) \
+    { \
+        if (!this_Stack || TYPED_STACK_HEADER (this_Stack)->pointer <= -1) \
+        { \
+            writeline ("Topping from a non-existent stack!!!\n", stderr); \
+            return 0; \
+        } \
+        *item = this_Stack[TYPED_STACK_HEADER (this_Stack)->pointer]; \
+        return 1; \
+    }
+
+DECLARE_TYPED_STACK (Int32Stack, int32_t)
+DECLARE_TYPED_STACK (Int64Stack, int64_t)
+DECLARE_TYPED_STACK (DoubleStack, double)
+DECLARE_TYPED_STACK (PtrStack, void *)
+
+#endif
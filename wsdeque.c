@@ -0,0 +1,428 @@
+/******************************************************************************
+
+File Name:      wsdeque.c
+Description:    This program implements a Chase-Lev work-stealing deque of
+                longs.  Its owner pushes and pops at the top as on a stack,
+                with plain loads and stores of its own index, while other
+                threads steal from the bottom with a compare-and-swap.  The
+                indices count up for ever and are reduced to a slot of the
+                circular array with a mask, and the owner doubles the array
+                when it fills.
+
+******************************************************************************/
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "mylib.h"
+#include "wsdeque.h"
+
+#define CACHE_LINE 64                   /* bytes in a cache line */
+#define MAX_SLOTS (1UL << 40)           /* largest array that can be made */
+
+/* catastrophic error messages */
+static const char ALLOCATE_FAILED[] = "Allocating a deque failed!!!\n";
+static const char DELETE_NONEXIST[] = "Deleting a non-existent deque!!!\n";
+static const char INCOMING_NONEXIST[] =
+                        "Incoming parameter does not exist!!!\n";
+static const char ISEMPTY_NONEXIST[] =
+                        "Isempty check from a non-existent deque!!!\n";
+static const char POP_NONEXIST[] = "Popping from a non-existent deque!!!\n";
+static const char PUSH_NONEXIST[] = "Pushing to a non-existent deque!!!\n";
+static const char STEAL_NONEXIST[] =
+                        "Stealing from a non-existent deque!!!\n";
+
+/* A circular array of elements.  The slots are atomic since a thief may
+ * read a slot while the owner writes the one beside it, and an array that
+ * was grown out of is kept on the list of older ones. */
+typedef struct WSArray
+{
+    struct WSArray * older;             /* the array this one replaced */
+    unsigned long mask;                 /* slots - 1 */
+    _Atomic long slots[];               /* the elements */
+} WSArray;
+
+/* The owner's index and array are on one cache line and the thieves'
+ * index on another, so that pushes and pops do not take the line thieves
+ * are fighting over.  The elements are the slots from bottom up to, but
+ * not including, top. */
+struct WSDeque
+{
+    _Alignas (CACHE_LINE) _Atomic long top; /* next slot to push */
+    _Atomic (WSArray *) array;              /* the current array */
+    _Alignas (CACHE_LINE) _Atomic long bottom; /* next slot to steal */
+};
+
+static WSArray * grow_array (WSDeque * this_Deque, WSArray * array,
+                             long bottom, long top);
+static WSArray * new_array (unsigned long size);
+
+
+/*----------------------------------------------------------------------------
+Function Name:          delete_WSDeque
+Purpose:                This function deletes a created deque
+Description:            This function checks to see if the deque exists. If
+                        not, an error message is printed. If so, the current
+                        array, every array it replaced and the deque itself
+                        are deallocated and the caller's pointer is set to
+                        NULL. The caller must make sure no other thread is
+                        still using the deque
+Input:                  dpp: the deque from which we will deallocate memory
+Result:                 Deletes the created deque or prints an error message
+----------------------------------------------------------------------------*/
+void delete_WSDeque (WSDeque ** dpp)
+{
+    WSArray * array = 0;        /* the array being deallocated */
+    WSArray * older = 0;        /* the array it replaced */
+
+    /* If statement is executed if dpp or the deque it points to does not
+     * exist */
+    if (!dpp || !*dpp)
+    {
+        writeline (DELETE_NONEXIST, stderr);   /* error message printed */
+        return;
+    }
+
+    array = atomic_load_explicit (&(*dpp)->array, memory_order_relaxed);
+
+    while (array)
+    {
+        older = array->older;
+        free (array);
+        array = older;
+    }
+
+    free (*dpp);
+    *dpp = NULL;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          isempty_WSDeque
+Purpose:                This function checks to see if the deque is empty
+Description:            This function compares the bottom and top indices.
+                        Since other threads may push, pop or steal at the
+                        same time, the answer only describes the moment the
+                        indices were read
+Input:                  this_Deque: the deque being checked
+Result:                 True if the deque is empty, false if it is not, and
+                        true with an error message if the deque does not
+                        exist
+----------------------------------------------------------------------------*/
+long isempty_WSDeque (WSDeque * this_Deque)
+{
+    long bottom = 0;            /* oldest element */
+
+    /* If statement is executed if the deque is not yet set */
+    if (!this_Deque)
+    {
+        writeline (ISEMPTY_NONEXIST, stderr);  /* error message printed */
+        return 1;
+    }
+
+    bottom = atomic_load_explicit (&this_Deque->bottom, memory_order_acquire);
+
+    return bottom >= atomic_load_explicit (&this_Deque->top,
+                                           memory_order_acquire);
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          new_WSDeque
+Purpose:                This function allocates a deque
+Description:            This function rounds the room asked for up to a power
+                        of two and allocates the deque on its own cache lines
+                        and its first array, with both indices at 0
+Input:                  size: the fewest elements the deque holds before its
+                              array is first grown
+Result:                 The new deque, or NULL if it is too large or memory
+                        could not be allocated and an error message is
+                        printed
+----------------------------------------------------------------------------*/
+WSDeque * new_WSDeque (unsigned long size)
+{
+    WSDeque * this_Deque = 0;   /* the new deque */
+    WSArray * array = 0;        /* its first array */
+    unsigned long slots = 1;    /* size rounded up to a power of two */
+
+    /* If statement is executed if the array would be too large */
+    if (size > MAX_SLOTS)
+    {
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    while (slots < size)
+    {
+        slots <<= 1;
+    }
+
+    this_Deque = aligned_alloc (CACHE_LINE, sizeof(WSDeque));
+    array = new_array (slots);
+
+    /* If statement is executed if the deque or its array could not be
+     * allocated */
+    if (!this_Deque || !array)
+    {
+        free (this_Deque);
+        free (array);
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    atomic_init (&this_Deque->top, 0);
+    atomic_init (&this_Deque->array, array);
+    atomic_init (&this_Deque->bottom, 0);
+
+    return this_Deque;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          pop_WSDeque
+Purpose:                This function removes the newest item in the deque
+Description:            This function claims the top slot by lowering the
+                        top index and only then reads the bottom index, both
+                        sequentially consistent, so that a thief either sees
+                        the slot claimed or is seen here. While more than one
+                        element is left no thief can reach the top slot and
+                        it is taken with no compare-and-swap. The last
+                        element is raced for with a compare-and-swap on the
+                        bottom index, as the thieves do. Only the owner may
+                        call this function. An empty deque is an expected
+                        state, so it is reported only through the result
+Input:                  this_Deque: the deque from which we are getting our
+                                    items
+                        item: the number we will remove from the deque
+Result:                 True if an item was removed. False if the deque is
+                        empty or a thief took its last item, or if the deque
+                        or item does not exist and an error message is
+                        printed
+----------------------------------------------------------------------------*/
+long pop_WSDeque (WSDeque * this_Deque, long * item)
+{
+    WSArray * array = 0;        /* the current array */
+    long top = 0;               /* slot being popped */
+    long bottom = 0;            /* oldest element */
+    long won = 1;               /* whether the slot was taken */
+
+    /* If statement is executed if the deque is not yet set */
+    if (!this_Deque)
+    {
+        writeline (POP_NONEXIST, stderr);     /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the item is not yet set */
+    if (!item)
+    {
+        writeline (INCOMING_NONEXIST, stderr); /* error message printed */
+        return 0;
+    }
+
+    top = atomic_load_explicit (&this_Deque->top, memory_order_relaxed) - 1;
+    array = atomic_load_explicit (&this_Deque->array, memory_order_relaxed);
+    atomic_store_explicit (&this_Deque->top, top, memory_order_seq_cst);
+    bottom = atomic_load_explicit (&this_Deque->bottom, memory_order_seq_cst);
+
+    /* If statement is executed if the deque was empty */
+    if (bottom > top)
+    {
+        atomic_store_explicit (&this_Deque->top, top + 1,
+                               memory_order_relaxed);
+        return 0;
+    }
+
+    *item = atomic_load_explicit (&array->slots[top & array->mask],
+                                  memory_order_relaxed);
+
+    /* If statement is executed if this is the last element, which a thief
+     * may be stealing too */
+    if (bottom == top)
+    {
+        won = atomic_compare_exchange_strong_explicit (&this_Deque->bottom,
+                                                       &bottom, bottom + 1,
+                                                       memory_order_seq_cst,
+                                                       memory_order_relaxed);
+        atomic_store_explicit (&this_Deque->top, top + 1,
+                               memory_order_relaxed);
+    }
+
+    return won;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          push_WSDeque
+Purpose:                This function adds a new element to the top of the
+                        deque
+Description:            This function grows the array when it is full, stores
+                        the item in the top slot and publishes it with a
+                        release store of the top index. Only the owner may
+                        call this function
+Input:                  this_Deque: the deque in question
+                        item: the long being stored to the top of the deque
+Result:                 True if the item was added. False if the array could
+                        not be grown, or the deque does not exist, and an
+                        error message is printed
+----------------------------------------------------------------------------*/
+long push_WSDeque (WSDeque * this_Deque, long item)
+{
+    WSArray * array = 0;        /* the current array */
+    long top = 0;               /* slot being pushed */
+    long bottom = 0;            /* oldest element */
+
+    /* If statement is executed if the deque is not yet set */
+    if (!this_Deque)
+    {
+        writeline (PUSH_NONEXIST, stderr);     /* error message printed */
+        return 0;
+    }
+
+    top = atomic_load_explicit (&this_Deque->top, memory_order_relaxed);
+    bottom = atomic_load_explicit (&this_Deque->bottom, memory_order_acquire);
+    array = atomic_load_explicit (&this_Deque->array, memory_order_relaxed);
+
+    /* If statement is executed if the array is full and cannot be grown */
+    if ( (unsigned long)(top - bottom) > array->mask &&
+         !(array = grow_array (this_Deque, array, bottom, top)) )
+    {
+        return 0;
+    }
+
+    atomic_store_explicit (&array->slots[top & array->mask], item,
+                           memory_order_relaxed);
+    atomic_store_explicit (&this_Deque->top, top + 1, memory_order_release);
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          steal_WSDeque
+Purpose:                This function removes the oldest item in the deque
+Description:            This function reads the bottom and then the top
+                        index, and if the deque is not empty reads the bottom
+                        slot and claims it with a compare-and-swap on the
+                        bottom index. A failed compare-and-swap means the
+                        owner or another thief took the slot first, and the
+                        item read is thrown away. Any thread may call this
+                        function
+Input:                  this_Deque: the deque from which we are getting our
+                                    items
+                        item: the number we will remove from the deque
+Result:                 True if an item was stolen. WS_BUSY if the attempt
+                        lost a race with another thread. False if the deque
+                        is empty, or if the deque or item does not exist and
+                        an error message is printed
+----------------------------------------------------------------------------*/
+long steal_WSDeque (WSDeque * this_Deque, long * item)
+{
+    WSArray * array = 0;        /* the current array */
+    long bottom = 0;            /* slot being stolen */
+    long top = 0;               /* next slot to push */
+    long value = 0;             /* the element read */
+
+    /* If statement is executed if the deque is not yet set */
+    if (!this_Deque)
+    {
+        writeline (STEAL_NONEXIST, stderr);   /* error message printed */
+        return 0;
+    }
+
+    /* If statement is executed if the item is not yet set */
+    if (!item)
+    {
+        writeline (INCOMING_NONEXIST, stderr); /* error message printed */
+        return 0;
+    }
+
+    bottom = atomic_load_explicit (&this_Deque->bottom, memory_order_seq_cst);
+    top = atomic_load_explicit (&this_Deque->top, memory_order_seq_cst);
+
+    /* If statement is executed if the deque is empty */
+    if (bottom >= top)
+    {
+        return 0;
+    }
+
+    array = atomic_load_explicit (&this_Deque->array, memory_order_acquire);
+    value = atomic_load_explicit (&array->slots[bottom & array->mask],
+                                  memory_order_relaxed);
+
+    /* If statement is executed if another thread took the slot first */
+    if ( !atomic_compare_exchange_strong_explicit (&this_Deque->bottom,
+                                                   &bottom, bottom + 1,
+                                                   memory_order_seq_cst,
+                                                   memory_order_relaxed) )
+    {
+        return WS_BUSY;
+    }
+
+    *item = value;
+
+    return 1;
+}
+
+
+/*----------------------------------------------------------------------------
+Function Name:          grow_array
+Purpose:                This function doubles the array of a full deque
+Description:            This function copies the elements from bottom up to
+                        top into an array twice the size, at the same
+                        indices, and publishes it with a release store. The
+                        old array is kept on the new one's list, since a
+                        thief that read the old array may still read a slot
+                        from it, and the slot it reads there holds the same
+                        element
+Input:                  this_Deque: the deque in question
+                        array: the current, full array
+                        bottom: the oldest element
+                        top: the next slot to push
+Result:                 The new array, or NULL if it could not be allocated
+                        and an error message is printed
+----------------------------------------------------------------------------*/
+static WSArray * grow_array (WSDeque * this_Deque, WSArray * array,
+                             long bottom, long top)
+{
+    WSArray * grown = 0;        /* the array twice the size */
+    long index = 0;             /* index of the element being copied */
+
+    /* If statement is executed if the array would be too large */
+    if (array->mask + 1 > MAX_SLOTS / 2 ||
+        !(grown = new_array ( (array->mask + 1) * 2 )) )
+    {
+        writeline (ALLOCATE_FAILED, stderr);   /* error message printed */
+        return NULL;
+    }
+
+    for (index = bottom; index < top; index++)
+    {
+        atomic_store_explicit (&grown->slots[index & grown->mask],
+                               atomic_load_explicit (
+                                   &array->slots[index & array->mask],
+                                   memory_order_relaxed),
+                               memory_order_relaxed);
+    }
+
+    grown->older = array;
+    atomic_store_explicit (&this_Deque->array, grown, memory_order_release);
+
+    return grown;
+}
+
+
+/* allocates an array of size slots, a power of two, or sends back NULL */
+static WSArray * new_array (unsigned long size)
+{
+    WSArray * array = malloc (sizeof(WSArray) + size * sizeof(_Atomic long));
+
+    /* If statement is executed if the array was allocated */
+    if (array)
+    {
+        array->older = NULL;
+        array->mask = size - 1;
+    }
+
+    return array;
+}
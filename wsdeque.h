@@ -0,0 +1,41 @@
+#ifndef WSDEQUE_H
+#define WSDEQUE_H
+
+/* This work-stealing deque is a Chase-Lev deque of longs.  It has one
+owner, who pushes and pops at the top like a stack and needs no
+compare-and-swap to do it, and any number of thieves, who steal the oldest
+element from the bottom with a compare-and-swap on the bottom index.  Only
+the last element is contended, and there the owner also takes it with a
+compare-and-swap.  The elements are kept in a circular array of a power of
+two in size that the owner doubles when it is full.  Arrays it replaces are
+kept until the deque is deleted, since a thief may still be reading one. */
+
+#define WS_BUSY (-2)    /* result of a steal that lost a race */
+
+typedef struct WSDeque WSDeque;
+
+void delete_WSDeque (WSDeque **); /* deallocates memory allocated in
+                                   new_WSDeque and by its growth.  No other
+                                   thread may be using the deque.  Assigns
+                                   incoming pointer to NULL. */
+long isempty_WSDeque (WSDeque *); /* returns 0 or non-0 value indicating
+                                   whether or not the deque is empty */
+WSDeque * new_WSDeque (unsigned long); /* allocates the deque with room for
+                                   at least the given number of elements.
+                                   Result is the new deque, or NULL if
+                                   memory could not be allocated */
+long pop_WSDeque (WSDeque *, long *); /* owner only.  Removes and sends back
+                                   the newest element.  Result is 0 or non-0,
+                                   indicating failure or success,
+                                   respectively */
+long push_WSDeque (WSDeque *, long); /* owner only.  Places one value on
+                                   top, growing the deque when it is full.
+                                   Result is 0 or non-0 indicating failure
+                                   or success, respectively */
+long steal_WSDeque (WSDeque *, long *); /* any thread.  Removes and sends
+                                   back the oldest element.  Result is 0 or
+                                   non-0 indicating failure or success,
+                                   respectively, or WS_BUSY if another
+                                   thread took the element first */
+
+#endif